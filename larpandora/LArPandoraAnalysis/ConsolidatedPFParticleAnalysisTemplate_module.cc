@@ -7,10 +7,14 @@
 #include "art/Framework/Core/EDAnalyzer.h"
 #include "art/Framework/Core/ModuleMacros.h"
 
+#include "canvas/Persistency/Common/FindManyP.h"
+
 #include "lardataobj/RecoBase/PFParticle.h"
+#include "lardataobj/RecoBase/PFParticleMetadata.h"
 #include "lardataobj/RecoBase/Shower.h"
 #include "lardataobj/RecoBase/Track.h"
 
+#include <map>
 #include <string>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -23,10 +27,47 @@ namespace lar_pandora {
   class ConsolidatedPFParticleAnalysisTemplate : public art::EDAnalyzer {
   public:
     typedef art::Handle<std::vector<recob::PFParticle>> PFParticleHandle;
-    typedef std::map<size_t, art::Ptr<recob::PFParticle>> PFParticleIdMap;
     typedef std::vector<art::Ptr<recob::PFParticle>> PFParticleVector;
     typedef std::vector<art::Ptr<recob::Track>> TrackVector;
     typedef std::vector<art::Ptr<recob::Shower>> ShowerVector;
+    typedef art::FindManyP<recob::Track> PFParticleToTrackAssoc;
+    typedef art::FindManyP<recob::Shower> PFParticleToShowerAssoc;
+    typedef art::FindManyP<larpandoraobj::PFParticleMetadata> PFParticleToMetadataAssoc;
+
+    /**
+     *  @brief  Per-event index from PFParticle ID to the art ptr to the PFParticle itself, for fast navigation
+     *
+     *  The Pandora output sets the ID of each PFParticle to its position in the collection, in which case the index is a
+     *  plain vector lookup; a map from ID to particle is only built as a fallback for collections with sparse IDs.
+     */
+    class PFParticleIdIndex {
+    public:
+      /**
+       *  @brief  Constructor
+       *
+       *  @param  pfParticleHandle the handle for the PFParticle collection
+       */
+      explicit PFParticleIdIndex(const PFParticleHandle& pfParticleHandle);
+
+      /**
+       *  @brief  Get the PFParticles, in order of increasing ID
+       */
+      const PFParticleVector& GetParticles() const { return m_particles; }
+
+      /**
+       *  @brief  Find the PFParticle with a given ID
+       *
+       *  @param  id the PFParticle ID
+       *
+       *  @return address of the PFParticle, or nullptr if there is no PFParticle with this ID
+       */
+      const art::Ptr<recob::PFParticle>* Find(const size_t id) const;
+
+    private:
+      PFParticleVector m_particles;             ///< The PFParticles, in order of increasing ID
+      bool m_isIdPosition;                      ///< Whether the ID of each PFParticle is its position
+      std::map<size_t, size_t> m_idToPosition; ///< Fallback mapping from ID to position, for sparse IDs
+    };
 
     /**
      *  @brief  Constructor
@@ -51,30 +92,22 @@ namespace lar_pandora {
 
   private:
     /**
-     *  @brief  Produce a mapping from PFParticle ID to the art ptr to the PFParticle itself for fast navigation
+     * @brief Print out scores in PFParticleMetadata, in the order of the PFParticle collection
      *
-     *  @param  pfParticleHandle the handle for the PFParticle collection
-     *  @param  pfParticleMap the mapping from ID to PFParticle
-     */
-    void GetPFParticleIdMap(const PFParticleHandle& pfParticleHandle,
-                            PFParticleIdMap& pfParticleMap);
-
-    /**
-     * @brief Print out scores in PFParticleMetadata
-     *
-     * @param evt the art event to analyze
      * @param pfParticleHandle the handle for the PFParticle collection
+     * @param pfPartToMetadataAssoc the associations between PFParticles and metadata
      */
-    void PrintOutScores(const art::Event& evt, const PFParticleHandle& pfParticleHandle) const;
+    void PrintOutScores(const PFParticleHandle& pfParticleHandle,
+                        const PFParticleToMetadataAssoc& pfPartToMetadataAssoc) const;
 
     /**
-     *  @brief  Produce a mapping from PFParticle ID to the art ptr to the PFParticle itself for fast navigation
+     *  @brief  Produce vectors of the final-state PFParticles under the cosmic and neutrino hypotheses
      *
-     *  @param  pfParticleMap the mapping from ID to PFParticle
+     *  @param  pfParticleIndex the index of the PFParticles
      *  @param  crParticles a vector to hold the top-level PFParticles reconstructed under the cosmic hypothesis
      *  @param  nuParticles a vector to hold the final-states of the reconstruced neutrino
      */
-    void GetFinalStatePFParticleVectors(const PFParticleIdMap& pfParticleMap,
+    void GetFinalStatePFParticleVectors(const PFParticleIdIndex& pfParticleIndex,
                                         PFParticleVector& crParticles,
                                         PFParticleVector& nuParticles);
 
@@ -82,14 +115,14 @@ namespace lar_pandora {
      *  @brief  Collect associated tracks and showers to particles in an input particle vector
      *
      *  @param  particles a vector holding PFParticles from which to find the associated tracks and showers
-     *  @param  pfParticleHandle the handle for the PFParticle collection
-     *  @param  evt the art event to analyze
+     *  @param  pfPartToTrackAssoc the associations between PFParticles and tracks
+     *  @param  pfPartToShowerAssoc the associations between PFParticles and showers
      *  @param  tracks a vector to hold the associated tracks
      *  @param  showers a vector to hold the associated showers
      */
     void CollectTracksAndShowers(const PFParticleVector& particles,
-                                 const PFParticleHandle& pfParticleHandle,
-                                 const art::Event& evt,
+                                 const PFParticleToTrackAssoc& pfPartToTrackAssoc,
+                                 const PFParticleToShowerAssoc& pfPartToShowerAssoc,
                                  TrackVector& tracks,
                                  ShowerVector& showers);
 
@@ -111,14 +144,12 @@ namespace lar_pandora {
 #include "art/Framework/Services/Registry/ServiceHandle.h"
 #include "art_root_io/TFileDirectory.h"
 #include "art_root_io/TFileService.h"
-#include "canvas/Persistency/Common/FindManyP.h"
 #include "fhiclcpp/ParameterSet.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
-#include "lardataobj/RecoBase/PFParticleMetadata.h"
-
 #include "Pandora/PdgTable.h"
 
+#include <algorithm>
 #include <iostream>
 
 namespace lar_pandora {
@@ -154,19 +185,25 @@ namespace lar_pandora {
       return;
     }
 
-    // Produce a map of the PFParticle IDs for fast navigation through the hierarchy
-    PFParticleIdMap pfParticleMap;
-    this->GetPFParticleIdMap(pfParticleHandle, pfParticleMap);
+    // Produce an index of the PFParticle IDs for fast navigation through the hierarchy
+    const PFParticleIdIndex pfParticleIndex(pfParticleHandle);
 
     /// Investigate scores associated as larpandoraobject::metadata for the PFParticles
-    if (m_printOutScores) this->PrintOutScores(evt, pfParticleHandle);
+    if (m_printOutScores) {
+      const PFParticleToMetadataAssoc pfPartToMetadataAssoc(pfParticleHandle, evt, m_pandoraLabel);
+      this->PrintOutScores(pfParticleHandle, pfPartToMetadataAssoc);
+    }
 
     // Produce two PFParticle vectors containing final-state particles:
     // 1. Particles identified as cosmic-rays - recontructed under cosmic-hypothesis
     // 2. Daughters of the neutrino PFParticle - reconstructed under the neutrino hypothesis
     std::vector<art::Ptr<recob::PFParticle>> crParticles;
     std::vector<art::Ptr<recob::PFParticle>> nuParticles;
-    this->GetFinalStatePFParticleVectors(pfParticleMap, crParticles, nuParticles);
+    this->GetFinalStatePFParticleVectors(pfParticleIndex, crParticles, nuParticles);
+
+    // Get the associations between PFParticles and tracks/showers from the event, once for all particles
+    const PFParticleToTrackAssoc pfPartToTrackAssoc(pfParticleHandle, evt, m_trackLabel);
+    const PFParticleToShowerAssoc pfPartToShowerAssoc(pfParticleHandle, evt, m_showerLabel);
 
     // Use as required!
     // -----------------------------
@@ -175,7 +212,8 @@ namespace lar_pandora {
     // These are the vectors to hold the tracks and showers for the final-states of the reconstructed neutrino
     std::vector<art::Ptr<recob::Track>> tracks;
     std::vector<art::Ptr<recob::Shower>> showers;
-    this->CollectTracksAndShowers(nuParticles, pfParticleHandle, evt, tracks, showers);
+    this->CollectTracksAndShowers(
+      nuParticles, pfPartToTrackAssoc, pfPartToShowerAssoc, tracks, showers);
 
     // Print a summary of the consolidated event
     std::cout << "Consolidated event summary:" << std::endl;
@@ -189,13 +227,31 @@ namespace lar_pandora {
 
   //------------------------------------------------------------------------------------------------------------------------------------------
 
-  void ConsolidatedPFParticleAnalysisTemplate::GetPFParticleIdMap(
-    const PFParticleHandle& pfParticleHandle,
-    PFParticleIdMap& pfParticleMap)
+  ConsolidatedPFParticleAnalysisTemplate::PFParticleIdIndex::PFParticleIdIndex(
+    const PFParticleHandle& pfParticleHandle)
+    : m_isIdPosition(true)
   {
+    m_particles.reserve(pfParticleHandle->size());
+
     for (unsigned int i = 0; i < pfParticleHandle->size(); ++i) {
       const art::Ptr<recob::PFParticle> pParticle(pfParticleHandle, i);
-      if (!pfParticleMap.insert(PFParticleIdMap::value_type(pParticle->Self(), pParticle)).second) {
+      m_particles.push_back(pParticle);
+
+      if (pParticle->Self() != i) m_isIdPosition = false;
+    }
+
+    if (m_isIdPosition) return;
+
+    // Fallback for sparse IDs: order the particles by ID and map each ID to its position
+    std::sort(m_particles.begin(),
+              m_particles.end(),
+              [](const art::Ptr<recob::PFParticle>& lhs, const art::Ptr<recob::PFParticle>& rhs) {
+                return (lhs->Self() < rhs->Self());
+              });
+
+    for (unsigned int i = 0; i < m_particles.size(); ++i) {
+      if (!m_idToPosition.insert(std::map<size_t, size_t>::value_type(m_particles[i]->Self(), i))
+             .second) {
         throw cet::exception("ConsolidatedPFParticleAnalysisTemplate")
           << "  Unable to get PFParticle ID map, the input PFParticle collection has repeat IDs!";
       }
@@ -204,32 +260,39 @@ namespace lar_pandora {
 
   //------------------------------------------------------------------------------------------------------------------------------------------
 
-  void ConsolidatedPFParticleAnalysisTemplate::PrintOutScores(
-    const art::Event& evt,
-    const PFParticleHandle& pfParticleHandle) const
+  const art::Ptr<recob::PFParticle>*
+  ConsolidatedPFParticleAnalysisTemplate::PFParticleIdIndex::Find(const size_t id) const
   {
-    // Get the associations between PFParticles and larpandoraobj::PFParticleMetadata
-    art::FindManyP<larpandoraobj::PFParticleMetadata> pfPartToMetadataAssoc(
-      pfParticleHandle, evt, m_pandoraLabel);
+    if (m_isIdPosition) return ((id < m_particles.size()) ? &m_particles[id] : nullptr);
+
+    const std::map<size_t, size_t>::const_iterator it(m_idToPosition.find(id));
+    return ((m_idToPosition.end() != it) ? &m_particles[it->second] : nullptr);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
 
+  void ConsolidatedPFParticleAnalysisTemplate::PrintOutScores(
+    const PFParticleHandle& pfParticleHandle,
+    const PFParticleToMetadataAssoc& pfPartToMetadataAssoc) const
+  {
     for (unsigned int i = 0; i < pfParticleHandle->size(); ++i) {
       const std::vector<art::Ptr<larpandoraobj::PFParticleMetadata>>& pfParticleMetadataList(
         pfPartToMetadataAssoc.at(i));
-      if (!pfParticleMetadataList.empty()) {
-        const art::Ptr<recob::PFParticle> pParticle(pfParticleHandle, i);
-        for (unsigned int j = 0; j < pfParticleMetadataList.size(); ++j) {
-          const art::Ptr<larpandoraobj::PFParticleMetadata>& pfParticleMetadata(
-            pfParticleMetadataList.at(j));
-          const larpandoraobj::PFParticleMetadata::PropertiesMap& pfParticlePropertiesMap(
-            pfParticleMetadata->GetPropertiesMap());
-          if (!pfParticlePropertiesMap.empty())
-            std::cout << " Found PFParticle " << pParticle->Self() << " with: " << std::endl;
-          for (larpandoraobj::PFParticleMetadata::PropertiesMap::const_iterator it =
-                 pfParticlePropertiesMap.begin();
-               it != pfParticlePropertiesMap.end();
-               ++it)
-            std::cout << "  - " << it->first << " = " << it->second << std::endl;
-        }
+      if (pfParticleMetadataList.empty()) continue;
+
+      const art::Ptr<recob::PFParticle> pParticle(pfParticleHandle, i);
+      for (unsigned int j = 0; j < pfParticleMetadataList.size(); ++j) {
+        const art::Ptr<larpandoraobj::PFParticleMetadata>& pfParticleMetadata(
+          pfParticleMetadataList.at(j));
+        const larpandoraobj::PFParticleMetadata::PropertiesMap& pfParticlePropertiesMap(
+          pfParticleMetadata->GetPropertiesMap());
+        if (!pfParticlePropertiesMap.empty())
+          std::cout << " Found PFParticle " << pParticle->Self() << " with: " << std::endl;
+        for (larpandoraobj::PFParticleMetadata::PropertiesMap::const_iterator it =
+               pfParticlePropertiesMap.begin();
+             it != pfParticlePropertiesMap.end();
+             ++it)
+          std::cout << "  - " << it->first << " = " << it->second << std::endl;
       }
     }
   }
@@ -237,13 +300,11 @@ namespace lar_pandora {
   //------------------------------------------------------------------------------------------------------------------------------------------
 
   void ConsolidatedPFParticleAnalysisTemplate::GetFinalStatePFParticleVectors(
-    const PFParticleIdMap& pfParticleMap,
+    const PFParticleIdIndex& pfParticleIndex,
     PFParticleVector& crParticles,
     PFParticleVector& nuParticles)
   {
-    for (PFParticleIdMap::const_iterator it = pfParticleMap.begin(); it != pfParticleMap.end();
-         ++it) {
-      const art::Ptr<recob::PFParticle> pParticle(it->second);
+    for (const art::Ptr<recob::PFParticle>& pParticle : pfParticleIndex.GetParticles()) {
 
       // Only look for primary particles
       if (!pParticle->IsPrimary()) continue;
@@ -268,11 +329,13 @@ namespace lar_pandora {
 
       // Add the daughters of the neutrino PFParticle to the nuPFParticles vector
       for (const size_t daughterId : pParticle->Daughters()) {
-        if (pfParticleMap.find(daughterId) == pfParticleMap.end())
+        const art::Ptr<recob::PFParticle>* const pDaughter(pfParticleIndex.Find(daughterId));
+
+        if (!pDaughter)
           throw cet::exception("ConsolidatedPFParticleAnalysisTemplate")
             << "  Invalid PFParticle collection!";
 
-        nuParticles.push_back(pfParticleMap.at(daughterId));
+        nuParticles.push_back(*pDaughter);
       }
     }
   }
@@ -281,19 +344,15 @@ namespace lar_pandora {
 
   void ConsolidatedPFParticleAnalysisTemplate::CollectTracksAndShowers(
     const PFParticleVector& particles,
-    const PFParticleHandle& pfParticleHandle,
-    const art::Event& evt,
+    const PFParticleToTrackAssoc& pfPartToTrackAssoc,
+    const PFParticleToShowerAssoc& pfPartToShowerAssoc,
     TrackVector& tracks,
     ShowerVector& showers)
   {
-    // Get the associations between PFParticles and tracks/showers from the event
-    art::FindManyP<recob::Track> pfPartToTrackAssoc(pfParticleHandle, evt, m_trackLabel);
-    art::FindManyP<recob::Shower> pfPartToShowerAssoc(pfParticleHandle, evt, m_showerLabel);
-
     for (const art::Ptr<recob::PFParticle>& pParticle : particles) {
-      const std::vector<art::Ptr<recob::Track>> associatedTracks(
+      const std::vector<art::Ptr<recob::Track>>& associatedTracks(
         pfPartToTrackAssoc.at(pParticle.key()));
-      const std::vector<art::Ptr<recob::Shower>> associatedShowers(
+      const std::vector<art::Ptr<recob::Shower>>& associatedShowers(
         pfPartToShowerAssoc.at(pParticle.key()));
       const unsigned int nTracks(associatedTracks.size());
       const unsigned int nShowers(associatedShowers.size());
@@ -283,20 +283,31 @@ namespace lar_pandora {
       std::cout << "  Event: " << m_event << std::endl;
     }
 
+    // Read the reconstructed products and their associations
+    // ======================================================
+    PFParticleProductLoader productLoader(m_particleLabel,
+                                          m_particleLabel,
+                                          m_particleLabel,
+                                          m_trackLabel,
+                                          m_showerLabel,
+                                          PFParticleProductLoader::kClusters |
+                                            PFParticleProductLoader::kSpacePoints |
+                                            PFParticleProductLoader::kVertices |
+                                            PFParticleProductLoader::kT0s |
+                                            PFParticleProductLoader::kTracks |
+                                            PFParticleProductLoader::kShowers);
+    productLoader.Load(evt);
+
     // Get the reconstructed PFParticles
     // =================================
-    PFParticleVector particleVector;
-    PFParticleVector particles1, particles2;
-    PFParticlesToClusters particlesToClusters;
-    PFParticlesToSpacePoints particlesToSpacePoints;
+    const PFParticleVector& particleVector(productLoader.GetPFParticles());
+    const PFParticlesToClusters& particlesToClusters(productLoader.GetPFParticlesToClusters());
+    const PFParticlesToSpacePoints& particlesToSpacePoints(
+      productLoader.GetPFParticlesToSpacePoints());
     PFParticlesToHits particlesToHits;
     HitsToPFParticles hitsToParticles;
 
-    LArPandoraHelper::CollectPFParticles(evt, m_particleLabel, particleVector);
-    LArPandoraHelper::CollectPFParticles(evt, m_particleLabel, particles1, particlesToClusters);
-    LArPandoraHelper::CollectPFParticles(evt, m_particleLabel, particles2, particlesToSpacePoints);
-    LArPandoraHelper::BuildPFParticleHitMaps(
-      evt, m_particleLabel, particlesToHits, hitsToParticles);
+    productLoader.BuildPFParticleHitMaps(particlesToHits, hitsToParticles);
 
     if (m_printDebug) std::cout << "  PFParticles: " << particleVector.size() << std::endl;
 
@@ -305,38 +316,18 @@ namespace lar_pandora {
       return;
     }
 
-    // Get the reconstructed vertices
-    // ==============================
-    VertexVector vertexVector;
-    PFParticlesToVertices particlesToVertices;
-    LArPandoraHelper::CollectVertices(evt, m_particleLabel, vertexVector, particlesToVertices);
-
-    // Get the reconstructed tracks
-    // ============================
-    TrackVector trackVector, trackVector2;
-    PFParticlesToTracks particlesToTracks;
-    TracksToHits tracksToHits;
-    LArPandoraHelper::CollectTracks(evt, m_trackLabel, trackVector, particlesToTracks);
-    LArPandoraHelper::CollectTracks(evt, m_trackLabel, trackVector2, tracksToHits);
-
-    // Get the reconstructed showers
-    // ============================
-    ShowerVector showerVector, showerVector2;
-    PFParticlesToShowers particlesToShowers;
-    ShowersToHits showersToHits;
-    LArPandoraHelper::CollectShowers(evt, m_showerLabel, showerVector, particlesToShowers);
-    LArPandoraHelper::CollectShowers(evt, m_showerLabel, showerVector2, showersToHits);
-
-    // Get the reconstructed T0 objects
-    // ================================
-    T0Vector t0Vector;
-    PFParticlesToT0s particlesToT0s;
-    LArPandoraHelper::CollectT0s(evt, m_particleLabel, t0Vector, particlesToT0s);
-
-    // Build an indexed map of the PFParticles
-    // =======================================
-    PFParticleMap particleMap;
-    LArPandoraHelper::BuildPFParticleMap(particleVector, particleMap);
+    // Get the reconstructed vertices, tracks, showers and T0 objects
+    // ==============================================================
+    const PFParticlesToVertices& particlesToVertices(productLoader.GetPFParticlesToVertices());
+    const PFParticlesToTracks& particlesToTracks(productLoader.GetPFParticlesToTracks());
+    const TracksToHits& tracksToHits(productLoader.GetTracksToHits());
+    const PFParticlesToShowers& particlesToShowers(productLoader.GetPFParticlesToShowers());
+    const ShowersToHits& showersToHits(productLoader.GetShowersToHits());
+    const PFParticlesToT0s& particlesToT0s(productLoader.GetPFParticlesToT0s());
+
+    // Build the hierarchy of the PFParticles
+    // ======================================
+    const PFParticleHierarchy particleHierarchy(particleVector);
 
     // Write PFParticle properties to ROOT file
     // ========================================
@@ -349,9 +340,9 @@ namespace lar_pandora {
       m_primary = particle->IsPrimary();
       m_parent = (particle->IsPrimary() ? -1 : particle->Parent());
       m_daughters = particle->NumDaughters();
-      m_generation = LArPandoraHelper::GetGeneration(particleMap, particle);
-      m_neutrino = LArPandoraHelper::GetParentNeutrino(particleMap, particle);
-      m_finalstate = LArPandoraHelper::IsFinalState(particleMap, particle);
+      m_generation = LArPandoraHelper::GetGeneration(particleHierarchy, particle);
+      m_neutrino = LArPandoraHelper::GetParentNeutrino(particleHierarchy, particle);
+      m_finalstate = LArPandoraHelper::IsFinalState(particleHierarchy, particle);
       m_vertex = 0;
       m_track = 0;
       m_trackid = -999;
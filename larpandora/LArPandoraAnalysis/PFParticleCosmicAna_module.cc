@@ -36,6 +36,7 @@ namespace lar_pandora {
 
     void beginJob();
     void endJob();
+    void beginRun(const art::Run& run);
     void analyze(const art::Event& evt);
     void reconfigure(fhicl::ParameterSet const& pset);
 
@@ -43,11 +44,11 @@ namespace lar_pandora {
     /**
      *  @brief Fill event-level variables using input maps between reconstructed objects
      *
-     *  @param  recoParticlesToHits  mapping from particles to hits
+     *  @param  recoHitIndex  index between particles and hits
      *  @param  recoParticlesToTracks  mapping from particles to tracks
      *  @param  recoTracksToCosmicTags  mapping from tracks to cosmic tags
      */
-    void FillRecoTree(const PFParticlesToHits& recoParticlesToHits,
+    void FillRecoTree(const PFParticleHitIndex& recoHitIndex,
                       const PFParticlesToTracks& recoParticlesToTracks,
                       const TracksToCosmicTags& recoTracksToCosmicTags);
 
@@ -56,14 +57,14 @@ namespace lar_pandora {
      *
      *  @param  hitVector  input vector of reconstructed hits
      *  @param  trueHitsToParticles  mapping between true hits and particles
-     *  @param  recoHitsToParticles  mapping between reconstructed hits and particles
+     *  @param  recoHitIndex  index between reconstructed particles and hits
      *  @param  particlesToTruth  mapping between MC particles and MC truth
      *  @param  particlesToTracks  mapping between reconstructed particles and tracks
      *  @param  tracksToCosmicTags  mapping between reconstructed tracks and cosmic tags
      */
     void FillTrueTree(const HitVector& hitVector,
                       const HitsToMCParticles& trueHitsToParticles,
-                      const HitsToPFParticles& recoHitsToParticles,
+                      const PFParticleHitIndex& recoHitIndex,
                       const MCParticlesToMCTruth& particlesToTruth,
                       const PFParticlesToTracks& particlesToTracks,
                       const TracksToCosmicTags& tracksToCosmicTags);
@@ -140,6 +141,13 @@ namespace lar_pandora {
     bool m_useDaughterMCParticles; ///<
 
     double m_cosmicContainmentCut; ///<
+
+    double m_detectorXMin; ///< The detector envelope, cached at the start of each run
+    double m_detectorXMax; ///<
+    double m_detectorYMin; ///<
+    double m_detectorYMax; ///<
+    double m_detectorZMin; ///<
+    double m_detectorZMax; ///<
   };
 
   DEFINE_ART_MODULE(PFParticleCosmicAna)
@@ -151,6 +159,7 @@ namespace lar_pandora {
 
 #include "art/Framework/Principal/Event.h"
 #include "art/Framework/Principal/Handle.h"
+#include "art/Framework/Principal/Run.h"
 #include "art/Framework/Services/Registry/ServiceHandle.h"
 #include "art_root_io/TFileDirectory.h"
 #include "art_root_io/TFileService.h"
@@ -169,7 +178,14 @@ namespace lar_pandora {
 
 namespace lar_pandora {
 
-  PFParticleCosmicAna::PFParticleCosmicAna(fhicl::ParameterSet const& pset) : art::EDAnalyzer(pset)
+  PFParticleCosmicAna::PFParticleCosmicAna(fhicl::ParameterSet const& pset)
+    : art::EDAnalyzer(pset)
+    , m_detectorXMin(0.0)
+    , m_detectorXMax(0.0)
+    , m_detectorYMin(0.0)
+    , m_detectorYMax(0.0)
+    , m_detectorZMin(0.0)
+    , m_detectorZMax(0.0)
   {
     this->reconfigure(pset);
   }
@@ -270,6 +286,20 @@ namespace lar_pandora {
 
   //------------------------------------------------------------------------------------------------------------------------------------------
 
+  void PFParticleCosmicAna::beginRun(const art::Run&)
+  {
+    art::ServiceHandle<geo::Geometry const> theGeometry;
+
+    m_detectorXMin = 0.0;
+    m_detectorXMax = 2.0 * theGeometry->DetHalfWidth();
+    m_detectorYMin = -theGeometry->DetHalfHeight();
+    m_detectorYMax = +theGeometry->DetHalfHeight();
+    m_detectorZMin = 0.0;
+    m_detectorZMax = theGeometry->DetLength();
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
   void PFParticleCosmicAna::analyze(const art::Event& evt)
   {
     std::cout << " *** PFParticleCosmicAna::analyze(...) *** " << std::endl;
@@ -307,18 +337,16 @@ namespace lar_pandora {
     // Collect Reco Particles
     // ======================
     PFParticleVector recoParticleVector;
-    PFParticlesToHits recoParticlesToHits;
-    HitsToPFParticles recoHitsToParticles;
+    PFParticleHitIndex recoHitIndex;
 
     LArPandoraHelper::CollectPFParticles(evt, m_particleLabel, recoParticleVector);
-    LArPandoraHelper::BuildPFParticleHitMaps(evt,
-                                             m_particleLabel,
-                                             m_particleLabel,
-                                             recoParticlesToHits,
-                                             recoHitsToParticles,
-                                             (m_useDaughterPFParticles ?
-                                                LArPandoraHelper::kAddDaughters :
-                                                LArPandoraHelper::kIgnoreDaughters));
+    LArPandoraHelper::BuildPFParticleHitIndex(evt,
+                                              m_particleLabel,
+                                              m_particleLabel,
+                                              recoHitIndex,
+                                              (m_useDaughterPFParticles ?
+                                                 LArPandoraHelper::kAddDaughters :
+                                                 LArPandoraHelper::kIgnoreDaughters));
 
     std::cout << "  PFParticles: " << recoParticleVector.size() << std::endl;
 
@@ -337,13 +365,13 @@ namespace lar_pandora {
 
     // Analyse Reconstructed Particles
     // ===============================
-    this->FillRecoTree(recoParticlesToHits, recoParticlesToTracks, recoTracksToCosmicTags);
+    this->FillRecoTree(recoHitIndex, recoParticlesToTracks, recoTracksToCosmicTags);
 
     // Analyse True Hits
     // =================
     this->FillTrueTree(hitVector,
                        trueHitsToParticles,
-                       recoHitsToParticles,
+                       recoHitIndex,
                        particlesToTruth,
                        recoParticlesToTracks,
                        recoTracksToCosmicTags);
@@ -351,20 +379,18 @@ namespace lar_pandora {
 
   //------------------------------------------------------------------------------------------------------------------------------------------
 
-  void PFParticleCosmicAna::FillRecoTree(const PFParticlesToHits& recoParticlesToHits,
+  void PFParticleCosmicAna::FillRecoTree(const PFParticleHitIndex& recoHitIndex,
                                          const PFParticlesToTracks& recoParticlesToTracks,
                                          const TracksToCosmicTags& recoTracksToCosmicTags)
   {
-    // Set up Geometry Service
-    // =======================
-    art::ServiceHandle<geo::Geometry const> theGeometry;
-
-    const double xmin(0.0);
-    const double xmax(2.0 * theGeometry->DetHalfWidth());
-    const double ymin(-theGeometry->DetHalfHeight());
-    const double ymax(+theGeometry->DetHalfHeight());
-    const double zmin(0.0);
-    const double zmax(theGeometry->DetLength());
+    // Detector envelope, cached at the start of the run
+    // =================================================
+    const double xmin(m_detectorXMin);
+    const double xmax(m_detectorXMax);
+    const double ymin(m_detectorYMin);
+    const double ymax(m_detectorYMax);
+    const double zmin(m_detectorZMin);
+    const double zmax(m_detectorZMax);
     const double xyzCut(m_cosmicContainmentCut);
 
     m_index = 0;
@@ -402,14 +428,12 @@ namespace lar_pandora {
 
     // Loop over Reco Particles
     // ========================
-    for (PFParticlesToHits::const_iterator iter1 = recoParticlesToHits.begin(),
-                                           iterEnd1 = recoParticlesToHits.end();
-         iter1 != iterEnd1;
-         ++iter1) {
-      const art::Ptr<recob::PFParticle> recoParticle = iter1->first;
+    for (size_t particleIndex = 0; particleIndex < recoHitIndex.GetNParticles(); ++particleIndex) {
+      const art::Ptr<recob::PFParticle>& recoParticle = recoHitIndex.GetParticle(particleIndex);
 
-      const HitVector& hitVector = iter1->second;
-      if (hitVector.empty()) continue;
+      const size_t nHits(recoHitIndex.HitsEnd(particleIndex) -
+                         recoHitIndex.HitsBegin(particleIndex));
+      if (0 == nHits) continue;
 
       PFParticlesToTracks::const_iterator iter2 = recoParticlesToTracks.find(recoParticle);
       if (recoParticlesToTracks.end() == iter2) continue;
@@ -417,7 +441,7 @@ namespace lar_pandora {
       const TrackVector& trackVector = iter2->second;
       if (trackVector.empty()) continue;
 
-      m_nHits = hitVector.size();
+      m_nHits = nHits;
       m_nTracks = trackVector.size();
 
       m_self = recoParticle->Self();
@@ -449,6 +473,9 @@ namespace lar_pandora {
       m_trackVtxContained = 0;
       m_trackEndContained = 0;
 
+      // Select the longest track (the last one, if several are equally long)
+      art::Ptr<recob::Track> longestTrack;
+
       for (TrackVector::const_iterator iter3 = trackVector.begin(), iterEnd3 = trackVector.end();
            iter3 != iterEnd3;
            ++iter3) {
@@ -458,6 +485,12 @@ namespace lar_pandora {
         if (trackLength < m_trackLength) continue;
 
         m_trackLength = trackLength;
+        longestTrack = track;
+      }
+
+      // Derive the wall distances and containment for the selected track only
+      if (longestTrack.isNonnull()) {
+        const art::Ptr<recob::Track>& track = longestTrack;
 
         const auto& trackVtxPosition = track->Vertex();
         const auto& trackVtxDirection = track->VertexDirection();
@@ -506,7 +539,7 @@ namespace lar_pandora {
 
   void PFParticleCosmicAna::FillTrueTree(const HitVector& hitVector,
                                          const HitsToMCParticles& trueHitsToParticles,
-                                         const HitsToPFParticles& recoHitsToParticles,
+                                         const PFParticleHitIndex& recoHitIndex,
                                          const MCParticlesToMCTruth& particlesToTruth,
                                          const PFParticlesToTracks& particlesToTracks,
                                          const TracksToCosmicTags& tracksToCosmicTags)
@@ -527,6 +560,10 @@ namespace lar_pandora {
     m_nCosmicHitsNotReconstructed = 0;
     m_nCosmicHitsReconstructed = 0;
 
+    // Cache the cosmic score of each reconstructed particle, which is shared by all of its hits
+    std::vector<float> cosmicScores(recoHitIndex.GetNParticles(), 0.f);
+    std::vector<bool> hasCosmicScore(recoHitIndex.GetNParticles(), false);
+
     for (HitVector::const_iterator iter2 = hitVector.begin(), iterEnd2 = hitVector.end();
          iter2 != iterEnd2;
          ++iter2) {
@@ -546,10 +583,15 @@ namespace lar_pandora {
 
       float cosmicScore(-0.2);
 
-      HitsToPFParticles::const_iterator iter5 = recoHitsToParticles.find(hit);
-      if (recoHitsToParticles.end() != iter5) {
-        const art::Ptr<recob::PFParticle> particle = iter5->second;
-        cosmicScore = this->GetCosmicScore(particle, particlesToTracks, tracksToCosmicTags);
+      size_t particleIndex(0);
+      if (recoHitIndex.GetParticleIndex(hit, particleIndex)) {
+        if (!hasCosmicScore.at(particleIndex)) {
+          cosmicScores.at(particleIndex) = this->GetCosmicScore(
+            recoHitIndex.GetParticle(particleIndex), particlesToTracks, tracksToCosmicTags);
+          hasCosmicScore.at(particleIndex) = true;
+        }
+
+        cosmicScore = cosmicScores.at(particleIndex);
       }
 
       ++m_nHits;
@@ -338,40 +338,36 @@ namespace lar_pandora {
 
     // Get particles, tracks, space points, hits (and wires)
     // ====================================================
-    TrackVector trackVector, trackVectorExtra;
-    ShowerVector showerVector, showerVectorExtra;
-    PFParticleVector particleVector;
-    SpacePointVector spacePointVector;
     HitVector hitVector;
     WireVector wireVector;
 
-    PFParticlesToTracks particlesToTracks;
-    PFParticlesToShowers particlesToShowers;
-    PFParticlesToSpacePoints particlesToSpacePoints;
     PFParticlesToHits particlesToHits, particlesToHitsClusters;
-    TracksToHits tracksToHits;
-    ShowersToHits showersToHits;
     HitsToPFParticles hitsToParticles, hitsToParticlesClusters;
-    SpacePointsToHits spacePointsToHits;
+
+    PFParticleProductLoader productLoader(m_particleLabel,
+                                          m_clusterLabel,
+                                          m_spacepointLabel,
+                                          m_trackLabel,
+                                          m_showerLabel,
+                                          PFParticleProductLoader::kClusters |
+                                            PFParticleProductLoader::kSpacePoints |
+                                            PFParticleProductLoader::kTracks |
+                                            PFParticleProductLoader::kShowers);
+    productLoader.Load(evt);
+
+    const PFParticleVector& particleVector(productLoader.GetPFParticles());
+    const PFParticlesToSpacePoints& particlesToSpacePoints(
+      productLoader.GetPFParticlesToSpacePoints());
+    const SpacePointsToHits& spacePointsToHits(productLoader.GetSpacePointsToHits());
+    const PFParticlesToTracks& particlesToTracks(productLoader.GetPFParticlesToTracks());
+    const TracksToHits& tracksToHits(productLoader.GetTracksToHits());
+    const PFParticlesToShowers& particlesToShowers(productLoader.GetPFParticlesToShowers());
+    const ShowersToHits& showersToHits(productLoader.GetShowersToHits());
 
     LArPandoraHelper::CollectHits(evt, m_hitfinderLabel, hitVector);
-    LArPandoraHelper::CollectSpacePoints(
-      evt, m_spacepointLabel, spacePointVector, spacePointsToHits);
-    LArPandoraHelper::CollectTracks(evt, m_trackLabel, trackVector, particlesToTracks);
-    LArPandoraHelper::CollectTracks(evt, m_trackLabel, trackVectorExtra, tracksToHits);
-    LArPandoraHelper::CollectShowers(evt, m_showerLabel, showerVector, particlesToShowers);
-    LArPandoraHelper::CollectShowers(evt, m_showerLabel, showerVectorExtra, showersToHits);
-    LArPandoraHelper::CollectPFParticles(
-      evt, m_particleLabel, particleVector, particlesToSpacePoints);
-    LArPandoraHelper::BuildPFParticleHitMaps(evt,
-                                             m_particleLabel,
-                                             m_spacepointLabel,
-                                             particlesToHits,
-                                             hitsToParticles,
-                                             LArPandoraHelper::DaughterMode::kUseDaughters,
-                                             false);
-    LArPandoraHelper::BuildPFParticleHitMaps(
-      evt, m_particleLabel, m_clusterLabel, particlesToHitsClusters, hitsToParticlesClusters);
+    productLoader.BuildPFParticleHitMaps(
+      particlesToHits, hitsToParticles, LArPandoraHelper::DaughterMode::kUseDaughters, false);
+    productLoader.BuildPFParticleHitMaps(particlesToHitsClusters, hitsToParticlesClusters);
 
     if (m_storeWires) LArPandoraHelper::CollectWires(evt, m_calwireLabel, wireVector);
 
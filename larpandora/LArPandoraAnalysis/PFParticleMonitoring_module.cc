@@ -41,9 +41,86 @@ namespace lar_pandora {
     void reconfigure(fhicl::ParameterSet const& pset);
 
   private:
-    typedef std::set<art::Ptr<recob::PFParticle>> PFParticleSet;
-    typedef std::set<art::Ptr<simb::MCParticle>> MCParticleSet;
-    typedef std::set<art::Ptr<simb::MCTruth>> MCTruthSet;
+    /**
+     *  @brief  Per-event table of hit attributes, in dense arrays indexed by hit
+     *
+     *  Hits from the input collection are indexed by their key; any other hits are appended as the owner maps are added.
+     */
+    class HitAttributeTable {
+    public:
+      /**
+       *  @brief  The owners recorded for each hit
+       */
+      enum Owner {
+        kRecoParticle = 0, ///< The reconstructed particle containing the hit
+        kRecoNeutrino,     ///< The reconstructed neutrino containing the hit
+        kTrueParticle,     ///< The true particle contributing the hit
+        kTrueNeutrino,     ///< The true neutrino contributing the hit
+        kNOwners           ///< The number of owner types
+      };
+
+      /**
+       *  @brief  Constructor
+       *
+       *  @param  hitVector the input collection of hits
+       */
+      HitAttributeTable(const HitVector& hitVector);
+
+      /**
+       *  @brief  Record the owner of each hit in a mapping from hits to owners
+       *
+       *  @param  owner the owner type
+       *  @param  hitsToOwners the mapping from hits to owners
+       */
+      template <typename T>
+      void SetOwners(const Owner owner,
+                     const std::map<art::Ptr<recob::Hit>, art::Ptr<T>>& hitsToOwners);
+
+      /**
+       *  @brief  Whether a hit has an owner of a given type
+       *
+       *  @param  owner the owner type
+       *  @param  hit the hit
+       */
+      bool HasOwner(const Owner owner, const art::Ptr<recob::Hit>& hit) const;
+
+      /**
+       *  @brief  Count the number of hits in each wire plane in a single pass
+       *
+       *  @param  hitVector the input vector of hits
+       *  @param  nHitsU the output number of hits in the U plane
+       *  @param  nHitsV the output number of hits in the V plane
+       *  @param  nHitsW the output number of hits in the W plane
+       */
+      void CountHitsByView(const HitVector& hitVector, int& nHitsU, int& nHitsV, int& nHitsW) const;
+
+    private:
+      /**
+       *  @brief  Get the index of a hit in the table
+       *
+       *  @param  hit the hit
+       *
+       *  @return the index, or an invalid index if the hit is not in the table
+       */
+      size_t GetIndex(const art::Ptr<recob::Hit>& hit) const;
+
+      /**
+       *  @brief  Get the index of a hit in the table, appending the hit if it is not yet in the table
+       *
+       *  @param  hit the hit
+       *
+       *  @return the index
+       */
+      size_t AddHit(const art::Ptr<recob::Hit>& hit);
+
+      art::ProductID m_productId; ///< The product ID of the input hit collection
+      size_t m_nCollectionHits;   ///< The number of hits in the input hit collection
+      std::map<art::Ptr<recob::Hit>, size_t>
+        m_otherHitIndices;      ///< The indices of hits from other collections
+      std::vector<int> m_views; ///< The view of each hit
+      std::vector<std::vector<size_t>>
+        m_ownerKeys; ///< For each owner type, the key of the owner of each hit
+    };
 
     /**
      *  @brief  Build mapping from true neutrinos to hits
@@ -62,11 +139,13 @@ namespace lar_pandora {
      *  @brief  Build mapping from reconstructed neutrinos to hits
      *
      *  @param recoParticleMap  the input mapping from reconstructed particle and particle ID
+     *  @param recoParticleHierarchy  the input hierarchy of reconstructed particles
      *  @param recoParticlesToHits  the input mapping from reconstructed particles to hits
      *  @param recoNeutrinosToHits  the output mapping from reconstructed particles to hits
      *  @param recoHitsToNeutrinos  the output mapping from reconstructed hits to particles
      */
     void BuildRecoNeutrinoHitMaps(const PFParticleMap& recoParticleMap,
+                                  const PFParticleHierarchy& recoParticleHierarchy,
                                   const PFParticlesToHits& recoParticlesToHits,
                                   PFParticlesToHits& recoNeutrinosToHits,
                                   HitsToPFParticles& recoHitsToNeutrinos) const;
@@ -84,23 +163,6 @@ namespace lar_pandora {
                               MCTruthToPFParticles& matchedNeutrinos,
                               MCTruthToHits& matchedNeutrinoHits) const;
 
-    /**
-     *  @brief Perform matching between true and reconstructed neutrino events
-     *
-     *  @param recoNeutrinosToHits  the mapping from reconstructed neutrino events to hits
-     *  @param trueHitsToNeutrinos  the mapping from hits to true neutrino events
-     *  @param matchedNeutrinos  the output matches between reconstructed and true neutrinos
-     *  @param matchedNeutrinoHits  the output matches between reconstructed neutrinos and hits
-     *  @param recoVeto  the veto list for reconstructed particles
-     *  @param trueVeto  the veto list for true particles
-     */
-    void GetRecoToTrueMatches(const PFParticlesToHits& recoNeutrinosToHits,
-                              const HitsToMCTruth& trueHitsToNeutrinos,
-                              MCTruthToPFParticles& matchedNeutrinos,
-                              MCTruthToHits& matchedNeutrinoHits,
-                              PFParticleSet& recoVeto,
-                              MCTruthSet& trueVeto) const;
-
     /**
      *  @brief Perform matching between true and reconstructed particles
      *
@@ -114,31 +176,6 @@ namespace lar_pandora {
                               MCParticlesToPFParticles& matchedParticles,
                               MCParticlesToHits& matchedHits) const;
 
-    /**
-     *  @brief Perform matching between true and reconstructed particles
-     *
-     *  @param recoParticlesToHits the mapping from reconstructed particles to hits
-     *  @param trueHitsToParticles the mapping from hits to true particles
-     *  @param matchedParticles the output matches between reconstructed and true particles
-     *  @param matchedHits the output matches between reconstructed particles and hits
-     *  @param recoVeto the veto list for reconstructed particles
-     *  @param trueVeto the veto list for true particles
-     */
-    void GetRecoToTrueMatches(const PFParticlesToHits& recoParticlesToHits,
-                              const HitsToMCParticles& trueHitsToParticles,
-                              MCParticlesToPFParticles& matchedParticles,
-                              MCParticlesToHits& matchedHits,
-                              PFParticleSet& recoVeto,
-                              MCParticleSet& trueVeto) const;
-
-    /**
-     *  @brief Count the number of reconstructed hits in a given wire plane
-     *
-     *  @param view the wire plane ID
-     *  @param hitVector the input vector of reconstructed hits
-     */
-    int CountHitsByType(const int view, const HitVector& hitVector) const;
-
     /**
      *  @brief Find the start and end points of the true particle in the active region of detector
      *
@@ -293,7 +330,9 @@ namespace lar_pandora {
 #include "nusimdata/SimulationBase/MCParticle.h"
 #include "nusimdata/SimulationBase/MCTruth.h"
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
 
 namespace lar_pandora {
 
@@ -618,6 +657,7 @@ namespace lar_pandora {
 
     LArPandoraHelper::BuildMCParticleMap(trueParticleVector, trueParticleMap);
     LArPandoraHelper::BuildPFParticleMap(recoParticleVector, recoParticleMap);
+    const PFParticleHierarchy recoParticleHierarchy(recoParticleVector);
 
     m_nMCParticles = trueParticlesToHits.size();
     m_nNeutrinoPfos = 0;
@@ -632,7 +672,7 @@ namespace lar_pandora {
       const art::Ptr<recob::PFParticle> recoParticle = *iter;
 
       if (LArPandoraHelper::IsNeutrino(recoParticle)) { m_nNeutrinoPfos++; }
-      else if (LArPandoraHelper::IsFinalState(recoParticleMap, recoParticle)) {
+      else if (LArPandoraHelper::IsFinalState(recoParticleHierarchy, recoParticle)) {
         m_nPrimaryPfos++;
       }
       else {
@@ -646,11 +686,20 @@ namespace lar_pandora {
     HitsToPFParticles recoHitsToNeutrinos;
     HitsToMCTruth trueHitsToNeutrinos;
     MCTruthToHits trueNeutrinosToHits;
-    this->BuildRecoNeutrinoHitMaps(
-      recoParticleMap, recoParticlesToHits, recoNeutrinosToHits, recoHitsToNeutrinos);
+    this->BuildRecoNeutrinoHitMaps(recoParticleMap,
+                                   recoParticleHierarchy,
+                                   recoParticlesToHits,
+                                   recoNeutrinosToHits,
+                                   recoHitsToNeutrinos);
     this->BuildTrueNeutrinoHitMaps(
       truthToParticles, trueParticlesToHits, trueNeutrinosToHits, trueHitsToNeutrinos);
 
+    HitAttributeTable hitAttributes(hitVector);
+    hitAttributes.SetOwners(HitAttributeTable::kRecoParticle, recoHitsToParticles);
+    hitAttributes.SetOwners(HitAttributeTable::kRecoNeutrino, recoHitsToNeutrinos);
+    hitAttributes.SetOwners(HitAttributeTable::kTrueParticle, trueHitsToParticles);
+    hitAttributes.SetOwners(HitAttributeTable::kTrueNeutrino, trueHitsToNeutrinos);
+
     MCTruthToPFParticles matchedNeutrinos;
     MCTruthToHits matchedNeutrinoHits;
     this->GetRecoToTrueMatches(
@@ -694,9 +743,7 @@ namespace lar_pandora {
       m_mcStraightLength = 0.0;
 
       m_nMCHits = trueHitVector.size();
-      m_nMCHitsU = this->CountHitsByType(geo::kU, trueHitVector);
-      m_nMCHitsV = this->CountHitsByType(geo::kV, trueHitVector);
-      m_nMCHitsW = this->CountHitsByType(geo::kW, trueHitVector);
+      hitAttributes.CountHitsByView(trueHitVector, m_nMCHitsU, m_nMCHitsV, m_nMCHitsW);
 
       m_pfoPdg = 0;
       m_pfoNuPdg = 0;
@@ -742,7 +789,7 @@ namespace lar_pandora {
                                      hIterEnd1 = trueHitVector.end();
            hIter1 != hIterEnd1;
            ++hIter1) {
-        if (recoHitsToNeutrinos.find(*hIter1) == recoHitsToNeutrinos.end())
+        if (!hitAttributes.HasOwner(HitAttributeTable::kRecoNeutrino, *hIter1))
           ++m_nTrueWithoutRecoHits;
       }
 
@@ -767,7 +814,7 @@ namespace lar_pandora {
                                          hIterEnd2 = recoHitVector.end();
                hIter2 != hIterEnd2;
                ++hIter2) {
-            if (trueHitsToNeutrinos.find(*hIter2) == trueHitsToNeutrinos.end())
+            if (!hitAttributes.HasOwner(HitAttributeTable::kTrueNeutrino, *hIter2))
               ++m_nRecoWithoutTrueHits;
           }
 
@@ -776,14 +823,11 @@ namespace lar_pandora {
             const HitVector& matchedHitVector = pIter3->second;
 
             m_nPfoHits = recoHitVector.size();
-            m_nPfoHitsU = this->CountHitsByType(geo::kU, recoHitVector);
-            m_nPfoHitsV = this->CountHitsByType(geo::kV, recoHitVector);
-            m_nPfoHitsW = this->CountHitsByType(geo::kW, recoHitVector);
+            hitAttributes.CountHitsByView(recoHitVector, m_nPfoHitsU, m_nPfoHitsV, m_nPfoHitsW);
 
             m_nMatchedHits = matchedHitVector.size();
-            m_nMatchedHitsU = this->CountHitsByType(geo::kU, matchedHitVector);
-            m_nMatchedHitsV = this->CountHitsByType(geo::kV, matchedHitVector);
-            m_nMatchedHitsW = this->CountHitsByType(geo::kW, matchedHitVector);
+            hitAttributes.CountHitsByView(
+              matchedHitVector, m_nMatchedHitsU, m_nMatchedHitsV, m_nMatchedHitsW);
 
             PFParticlesToVertices::const_iterator pIter4 =
               recoParticlesToVertices.find(recoParticle);
@@ -1006,29 +1050,27 @@ namespace lar_pandora {
                                      hIterEnd1 = trueHitVector.end();
            hIter1 != hIterEnd1;
            ++hIter1) {
-        if (recoHitsToParticles.find(*hIter1) == recoHitsToParticles.end())
+        if (!hitAttributes.HasOwner(HitAttributeTable::kRecoParticle, *hIter1))
           ++m_nTrueWithoutRecoHits;
       }
 
       // Match true and reconstructed hits
       m_nMCHits = trueHitVector.size();
-      m_nMCHitsU = this->CountHitsByType(geo::kU, trueHitVector);
-      m_nMCHitsV = this->CountHitsByType(geo::kV, trueHitVector);
-      m_nMCHitsW = this->CountHitsByType(geo::kW, trueHitVector);
+      hitAttributes.CountHitsByView(trueHitVector, m_nMCHitsU, m_nMCHitsV, m_nMCHitsW);
 
       MCParticlesToPFParticles::const_iterator pIter1 = matchedParticles.find(trueParticle);
       if (matchedParticles.end() != pIter1) {
         const art::Ptr<recob::PFParticle> recoParticle = pIter1->second;
         m_pfoPdg = recoParticle->PdgCode();
-        m_pfoNuPdg = LArPandoraHelper::GetParentNeutrino(recoParticleMap, recoParticle);
-        m_pfoIsPrimary = LArPandoraHelper::IsFinalState(recoParticleMap, recoParticle);
+        m_pfoNuPdg = LArPandoraHelper::GetParentNeutrino(recoParticleHierarchy, recoParticle);
+        m_pfoIsPrimary = LArPandoraHelper::IsFinalState(recoParticleHierarchy, recoParticle);
 
         const art::Ptr<recob::PFParticle> parentParticle =
-          LArPandoraHelper::GetParentPFParticle(recoParticleMap, recoParticle);
+          LArPandoraHelper::GetParentPFParticle(recoParticleHierarchy, recoParticle);
         m_pfoParentPdg = parentParticle->PdgCode();
 
         const art::Ptr<recob::PFParticle> primaryParticle =
-          LArPandoraHelper::GetFinalStatePFParticle(recoParticleMap, recoParticle);
+          LArPandoraHelper::GetFinalStatePFParticle(recoParticleHierarchy, recoParticle);
         m_pfoPrimaryPdg = primaryParticle->PdgCode();
 
         PFParticlesToHits::const_iterator pIter2 = recoParticlesToHits.find(recoParticle);
@@ -1042,7 +1084,7 @@ namespace lar_pandora {
                                        hIterEnd2 = recoHitVector.end();
              hIter2 != hIterEnd2;
              ++hIter2) {
-          if (trueHitsToParticles.find(*hIter2) == trueHitsToParticles.end())
+          if (!hitAttributes.HasOwner(HitAttributeTable::kTrueParticle, *hIter2))
             ++m_nRecoWithoutTrueHits;
         }
 
@@ -1054,14 +1096,11 @@ namespace lar_pandora {
         const HitVector& matchedHitVector = pIter3->second;
 
         m_nPfoHits = recoHitVector.size();
-        m_nPfoHitsU = this->CountHitsByType(geo::kU, recoHitVector);
-        m_nPfoHitsV = this->CountHitsByType(geo::kV, recoHitVector);
-        m_nPfoHitsW = this->CountHitsByType(geo::kW, recoHitVector);
+        hitAttributes.CountHitsByView(recoHitVector, m_nPfoHitsU, m_nPfoHitsV, m_nPfoHitsW);
 
         m_nMatchedHits = matchedHitVector.size();
-        m_nMatchedHitsU = this->CountHitsByType(geo::kU, matchedHitVector);
-        m_nMatchedHitsV = this->CountHitsByType(geo::kV, matchedHitVector);
-        m_nMatchedHitsW = this->CountHitsByType(geo::kW, matchedHitVector);
+        hitAttributes.CountHitsByView(
+          matchedHitVector, m_nMatchedHitsU, m_nMatchedHitsV, m_nMatchedHitsW);
 
         PFParticlesToVertices::const_iterator pIter4 = recoParticlesToVertices.find(recoParticle);
         if (recoParticlesToVertices.end() != pIter4) {
@@ -1169,10 +1208,12 @@ namespace lar_pandora {
 
   //------------------------------------------------------------------------------------------------------------------------------------------
 
-  void PFParticleMonitoring::BuildRecoNeutrinoHitMaps(const PFParticleMap& recoParticleMap,
-                                                      const PFParticlesToHits& recoParticlesToHits,
-                                                      PFParticlesToHits& recoNeutrinosToHits,
-                                                      HitsToPFParticles& recoHitsToNeutrinos) const
+  void PFParticleMonitoring::BuildRecoNeutrinoHitMaps(
+    const PFParticleMap& recoParticleMap,
+    const PFParticleHierarchy& recoParticleHierarchy,
+    const PFParticlesToHits& recoParticlesToHits,
+    PFParticlesToHits& recoNeutrinosToHits,
+    HitsToPFParticles& recoHitsToNeutrinos) const
   {
     for (PFParticleMap::const_iterator iter1 = recoParticleMap.begin(),
                                        iterEnd1 = recoParticleMap.end();
@@ -1180,7 +1221,7 @@ namespace lar_pandora {
          ++iter1) {
       const art::Ptr<recob::PFParticle> recoParticle = iter1->second;
       const art::Ptr<recob::PFParticle> recoNeutrino =
-        LArPandoraHelper::GetParentPFParticle(recoParticleMap, recoParticle);
+        LArPandoraHelper::GetParentPFParticle(recoParticleHierarchy, recoParticle);
 
       if (!LArPandoraHelper::IsNeutrino(recoNeutrino)) continue;
 
@@ -1206,95 +1247,11 @@ namespace lar_pandora {
                                                   MCTruthToPFParticles& matchedNeutrinos,
                                                   MCTruthToHits& matchedNeutrinoHits) const
   {
-    PFParticleSet recoVeto;
-    MCTruthSet trueVeto;
-
-    this->GetRecoToTrueMatches(recoNeutrinosToHits,
-                               trueHitsToNeutrinos,
-                               matchedNeutrinos,
-                               matchedNeutrinoHits,
-                               recoVeto,
-                               trueVeto);
-  }
-
-  //------------------------------------------------------------------------------------------------------------------------------------------
-
-  void PFParticleMonitoring::GetRecoToTrueMatches(const PFParticlesToHits& recoNeutrinosToHits,
-                                                  const HitsToMCTruth& trueHitsToNeutrinos,
-                                                  MCTruthToPFParticles& matchedNeutrinos,
-                                                  MCTruthToHits& matchedNeutrinoHits,
-                                                  PFParticleSet& vetoReco,
-                                                  MCTruthSet& vetoTrue) const
-  {
-    bool foundMatches(false);
-
-    for (PFParticlesToHits::const_iterator iter1 = recoNeutrinosToHits.begin(),
-                                           iterEnd1 = recoNeutrinosToHits.end();
-         iter1 != iterEnd1;
-         ++iter1) {
-      const art::Ptr<recob::PFParticle> recoNeutrino = iter1->first;
-      if (vetoReco.count(recoNeutrino) > 0) continue;
-
-      const HitVector& hitVector = iter1->second;
-
-      MCTruthToHits truthContributionMap;
-
-      for (HitVector::const_iterator iter2 = hitVector.begin(), iterEnd2 = hitVector.end();
-           iter2 != iterEnd2;
-           ++iter2) {
-        const art::Ptr<recob::Hit> hit = *iter2;
-
-        HitsToMCTruth::const_iterator iter3 = trueHitsToNeutrinos.find(hit);
-        if (trueHitsToNeutrinos.end() == iter3) continue;
-
-        const art::Ptr<simb::MCTruth> trueNeutrino = iter3->second;
-        if (vetoTrue.count(trueNeutrino) > 0) continue;
-
-        truthContributionMap[trueNeutrino].push_back(hit);
-      }
-
-      MCTruthToHits::const_iterator mIter = truthContributionMap.end();
-
-      for (MCTruthToHits::const_iterator iter4 = truthContributionMap.begin(),
-                                         iterEnd4 = truthContributionMap.end();
-           iter4 != iterEnd4;
-           ++iter4) {
-        if ((truthContributionMap.end() == mIter) ||
-            (iter4->second.size() > mIter->second.size())) {
-          mIter = iter4;
-        }
-      }
-
-      if (truthContributionMap.end() != mIter) {
-        const art::Ptr<simb::MCTruth> trueNeutrino = mIter->first;
-
-        MCTruthToHits::const_iterator iter5 = matchedNeutrinoHits.find(trueNeutrino);
-
-        if ((matchedNeutrinoHits.end() == iter5) || (mIter->second.size() > iter5->second.size())) {
-          matchedNeutrinos[trueNeutrino] = recoNeutrino;
-          matchedNeutrinoHits[trueNeutrino] = mIter->second;
-          foundMatches = true;
-        }
-      }
-    }
-
-    if (!foundMatches) return;
-
-    for (MCTruthToPFParticles::const_iterator pIter = matchedNeutrinos.begin(),
-                                              pIterEnd = matchedNeutrinos.end();
-         pIter != pIterEnd;
-         ++pIter) {
-      vetoTrue.insert(pIter->first);
-      vetoReco.insert(pIter->second);
-    }
-
-    if (m_recursiveMatching)
-      this->GetRecoToTrueMatches(recoNeutrinosToHits,
-                                 trueHitsToNeutrinos,
-                                 matchedNeutrinos,
-                                 matchedNeutrinoHits,
-                                 vetoReco,
-                                 vetoTrue);
+    LArPandoraHelper::MatchRecoToTrue(recoNeutrinosToHits,
+                                      trueHitsToNeutrinos,
+                                      m_recursiveMatching,
+                                      matchedNeutrinos,
+                                      matchedNeutrinoHits);
   }
 
   //------------------------------------------------------------------------------------------------------------------------------------------
@@ -1304,107 +1261,113 @@ namespace lar_pandora {
                                                   MCParticlesToPFParticles& matchedParticles,
                                                   MCParticlesToHits& matchedHits) const
   {
-    PFParticleSet recoVeto;
-    MCParticleSet trueVeto;
-
-    this->GetRecoToTrueMatches(
-      recoParticlesToHits, trueHitsToParticles, matchedParticles, matchedHits, recoVeto, trueVeto);
+    LArPandoraHelper::MatchRecoToTrue(
+      recoParticlesToHits, trueHitsToParticles, m_recursiveMatching, matchedParticles, matchedHits);
   }
 
   //------------------------------------------------------------------------------------------------------------------------------------------
 
-  void PFParticleMonitoring::GetRecoToTrueMatches(const PFParticlesToHits& recoParticlesToHits,
-                                                  const HitsToMCParticles& trueHitsToParticles,
-                                                  MCParticlesToPFParticles& matchedParticles,
-                                                  MCParticlesToHits& matchedHits,
-                                                  PFParticleSet& vetoReco,
-                                                  MCParticleSet& vetoTrue) const
+  PFParticleMonitoring::HitAttributeTable::HitAttributeTable(const HitVector& hitVector)
+    : m_productId(hitVector.empty() ? art::ProductID() : hitVector.front().id())
+    , m_nCollectionHits(0)
+    , m_ownerKeys(kNOwners)
   {
-    bool foundMatches(false);
+    for (const art::Ptr<recob::Hit>& hit : hitVector) {
+      if ((hit.id() != m_productId) || (hit.key() != m_nCollectionHits)) break;
 
-    for (PFParticlesToHits::const_iterator iter1 = recoParticlesToHits.begin(),
-                                           iterEnd1 = recoParticlesToHits.end();
-         iter1 != iterEnd1;
-         ++iter1) {
-      const art::Ptr<recob::PFParticle> recoParticle = iter1->first;
-      if (vetoReco.count(recoParticle) > 0) continue;
+      ++m_nCollectionHits;
+    }
 
-      const HitVector& hitVector = iter1->second;
+    m_views.reserve(m_nCollectionHits);
 
-      MCParticlesToHits truthContributionMap;
+    for (size_t i = 0; i < m_nCollectionHits; ++i)
+      m_views.push_back(hitVector[i]->View());
 
-      for (HitVector::const_iterator iter2 = hitVector.begin(), iterEnd2 = hitVector.end();
-           iter2 != iterEnd2;
-           ++iter2) {
-        const art::Ptr<recob::Hit> hit = *iter2;
+    for (std::vector<size_t>& ownerKeys : m_ownerKeys)
+      ownerKeys.assign(m_nCollectionHits, std::numeric_limits<size_t>::max());
 
-        HitsToMCParticles::const_iterator iter3 = trueHitsToParticles.find(hit);
-        if (trueHitsToParticles.end() == iter3) continue;
+    for (size_t i = m_nCollectionHits; i < hitVector.size(); ++i)
+      this->AddHit(hitVector[i]);
+  }
 
-        const art::Ptr<simb::MCParticle> trueParticle = iter3->second;
-        if (vetoTrue.count(trueParticle) > 0) continue;
+  //------------------------------------------------------------------------------------------------------------------------------------------
 
-        truthContributionMap[trueParticle].push_back(hit);
-      }
+  template <typename T>
+  void PFParticleMonitoring::HitAttributeTable::SetOwners(
+    const Owner owner,
+    const std::map<art::Ptr<recob::Hit>, art::Ptr<T>>& hitsToOwners)
+  {
+    for (typename std::map<art::Ptr<recob::Hit>, art::Ptr<T>>::const_iterator
+           iter = hitsToOwners.begin(),
+           iterEnd = hitsToOwners.end();
+         iter != iterEnd;
+         ++iter) {
+      const size_t index(this->AddHit(iter->first));
+      m_ownerKeys[owner][index] = iter->second.key();
+    }
+  }
 
-      MCParticlesToHits::const_iterator mIter = truthContributionMap.end();
+  //------------------------------------------------------------------------------------------------------------------------------------------
 
-      for (MCParticlesToHits::const_iterator iter4 = truthContributionMap.begin(),
-                                             iterEnd4 = truthContributionMap.end();
-           iter4 != iterEnd4;
-           ++iter4) {
-        if ((truthContributionMap.end() == mIter) ||
-            (iter4->second.size() > mIter->second.size())) {
-          mIter = iter4;
-        }
-      }
+  bool PFParticleMonitoring::HitAttributeTable::HasOwner(const Owner owner,
+                                                         const art::Ptr<recob::Hit>& hit) const
+  {
+    const size_t index(this->GetIndex(hit));
 
-      if (truthContributionMap.end() != mIter) {
-        const art::Ptr<simb::MCParticle> trueParticle = mIter->first;
+    return ((index < m_views.size()) &&
+            (m_ownerKeys[owner][index] != std::numeric_limits<size_t>::max()));
+  }
 
-        MCParticlesToHits::const_iterator iter5 = matchedHits.find(trueParticle);
+  //------------------------------------------------------------------------------------------------------------------------------------------
 
-        if ((matchedHits.end() == iter5) || (mIter->second.size() > iter5->second.size())) {
-          matchedParticles[trueParticle] = recoParticle;
-          matchedHits[trueParticle] = mIter->second;
-          foundMatches = true;
-        }
-      }
+  void PFParticleMonitoring::HitAttributeTable::CountHitsByView(const HitVector& hitVector,
+                                                                int& nHitsU,
+                                                                int& nHitsV,
+                                                                int& nHitsW) const
+  {
+    nHitsU = 0;
+    nHitsV = 0;
+    nHitsW = 0;
+
+    for (const art::Ptr<recob::Hit>& hit : hitVector) {
+      const size_t index(this->GetIndex(hit));
+      const int view((index < m_views.size()) ? m_views[index] : static_cast<int>(hit->View()));
+
+      if (geo::kU == view)
+        ++nHitsU;
+      else if (geo::kV == view)
+        ++nHitsV;
+      else if (geo::kW == view)
+        ++nHitsW;
     }
+  }
 
-    if (!foundMatches) return;
+  //------------------------------------------------------------------------------------------------------------------------------------------
 
-    for (MCParticlesToPFParticles::const_iterator pIter = matchedParticles.begin(),
-                                                  pIterEnd = matchedParticles.end();
-         pIter != pIterEnd;
-         ++pIter) {
-      vetoTrue.insert(pIter->first);
-      vetoReco.insert(pIter->second);
-    }
+  size_t PFParticleMonitoring::HitAttributeTable::GetIndex(const art::Ptr<recob::Hit>& hit) const
+  {
+    if ((hit.id() == m_productId) && (hit.key() < m_nCollectionHits)) return hit.key();
+
+    std::map<art::Ptr<recob::Hit>, size_t>::const_iterator iter = m_otherHitIndices.find(hit);
 
-    if (m_recursiveMatching)
-      this->GetRecoToTrueMatches(recoParticlesToHits,
-                                 trueHitsToParticles,
-                                 matchedParticles,
-                                 matchedHits,
-                                 vetoReco,
-                                 vetoTrue);
+    return ((m_otherHitIndices.end() != iter) ? iter->second :
+                                                std::numeric_limits<size_t>::max());
   }
 
   //------------------------------------------------------------------------------------------------------------------------------------------
 
-  int PFParticleMonitoring::CountHitsByType(const int view, const HitVector& hitVector) const
+  size_t PFParticleMonitoring::HitAttributeTable::AddHit(const art::Ptr<recob::Hit>& hit)
   {
-    int nHits(0);
+    const size_t index(this->GetIndex(hit));
+    if (index < m_views.size()) return index;
 
-    for (HitVector::const_iterator iter = hitVector.begin(), iterEnd = hitVector.end();
-         iter != iterEnd;
-         ++iter) {
-      const art::Ptr<recob::Hit> hit = *iter;
-      if (hit->View() == view) ++nHits;
-    }
+    m_otherHitIndices[hit] = m_views.size();
+    m_views.push_back(hit->View());
+
+    for (std::vector<size_t>& ownerKeys : m_ownerKeys)
+      ownerKeys.push_back(std::numeric_limits<size_t>::max());
 
-    return nHits;
+    return (m_views.size() - 1);
   }
 
   //------------------------------------------------------------------------------------------------------------------------------------------
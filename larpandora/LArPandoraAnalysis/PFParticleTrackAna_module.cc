@@ -193,6 +193,8 @@ namespace lar_pandora {
 
     m_ntracks = trackVector.size();
 
+    TrackTrajectoryArrays trajectoryArrays;
+
     for (TrackVector::const_iterator iter = trackVector.begin(), iterEnd = trackVector.end();
          iter != iterEnd;
          ++iter) {
@@ -214,18 +216,17 @@ namespace lar_pandora {
       m_py = 0.0;
       m_pz = 0.0;
 
-      for (unsigned int p = 0; p < track->NumberTrajectoryPoints(); ++p) {
-        auto pos = track->LocationAtPoint(p);
-        auto dir = track->DirectionAtPoint(p);
+      trajectoryArrays.Fill(track->Trajectory());
 
-        m_residualRange = track->Length(p);
+      for (unsigned int p = 0; p < trajectoryArrays.GetNPoints(); ++p) {
+        m_residualRange = trajectoryArrays.GetResidualRange()[p];
 
-        m_x = pos.x();
-        m_y = pos.y();
-        m_z = pos.z();
-        m_px = dir.x();
-        m_py = dir.y();
-        m_pz = dir.z();
+        m_x = trajectoryArrays.GetX()[p];
+        m_y = trajectoryArrays.GetY()[p];
+        m_z = trajectoryArrays.GetZ()[p];
+        m_px = trajectoryArrays.GetDirectionX()[p];
+        m_py = trajectoryArrays.GetDirectionY()[p];
+        m_pz = trajectoryArrays.GetDirectionZ()[p];
 
         /*************************************************************/
         /*                          WARNING                          */
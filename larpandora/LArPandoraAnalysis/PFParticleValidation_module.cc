@@ -469,19 +469,44 @@ namespace lar_pandora {
           mcParticleToHitsEntry.first, PFParticleToMatchedHits()));
     }
 
-    // Store true to reco matching details
-    for (const PFParticlesToHits::value_type& recoParticleToHits : pfParticlesToHits) {
-      const art::Ptr<recob::PFParticle> pRecoParticle(recoParticleToHits.first);
-      const HitVector& hitVector(recoParticleToHits.second);
+    // Store true to reco matching details, using the shared hit counts to find the matched hit vectors once per match
+    PFParticleVector recoParticles;
+    std::vector<std::vector<size_t>> recoHitIndices;
+    MCParticleVector trueParticles;
+    HitVector hits;
+    std::vector<size_t> hitsToTrueIndex;
+    LArPandoraHelper::BuildRecoTrueHitIndices(pfParticlesToHits,
+                                              hitsToMCParticles,
+                                              recoParticles,
+                                              recoHitIndices,
+                                              trueParticles,
+                                              hits,
+                                              hitsToTrueIndex);
+
+    RecoTrueOverlapTable<> overlapTable(hitsToTrueIndex, trueParticles.size());
+    std::vector<HitVector*> matchedHitVectors(trueParticles.size(), nullptr);
+
+    for (size_t recoIndex = 0; recoIndex < recoParticles.size(); ++recoIndex) {
+      const art::Ptr<recob::PFParticle> pRecoParticle(recoParticles[recoIndex]);
+      const RecoTrueOverlapTable<>::OverlapVector& overlaps(
+        overlapTable.GetOverlaps(overlapTable.AddRecoObject(recoHitIndices[recoIndex])));
+
+      for (const RecoTrueOverlapTable<>::TrueIndexAndWeight& overlap : overlaps) {
+        HitVector& matchedHits(mcParticleMatchingMap[trueParticles[overlap.first]][pRecoParticle]);
+        matchedHits.reserve(overlap.second);
+        matchedHitVectors[overlap.first] = &matchedHits;
+      }
 
-      for (const art::Ptr<recob::Hit> pHit : hitVector) {
-        HitsToMCParticles::const_iterator mcParticleIter = hitsToMCParticles.find(pHit);
+      for (const size_t hitIndex : recoHitIndices[recoIndex]) {
+        const size_t trueIndex(hitsToTrueIndex[hitIndex]);
 
-        if (hitsToMCParticles.end() == mcParticleIter) continue;
+        if (LArPandoraHelper::kNoTrueIndex == trueIndex) continue;
 
-        const art::Ptr<simb::MCParticle> pTrueParticle = mcParticleIter->second;
-        mcParticleMatchingMap[pTrueParticle][pRecoParticle].push_back(pHit);
+        matchedHitVectors[trueIndex]->push_back(hits[hitIndex]);
       }
+
+      for (const RecoTrueOverlapTable<>::TrueIndexAndWeight& overlap : overlaps)
+        matchedHitVectors[overlap.first] = nullptr;
     }
   }
 
@@ -18,6 +18,7 @@ namespace lar_pandora {
     , m_shouldProduceT0s(shouldProduceT0s)
   {
     this->GetCollections();
+    this->BuildIndexMaps();
   }
 
   //------------------------------------------------------------------------------------------------------------------------------------------
@@ -46,6 +47,8 @@ namespace lar_pandora {
       if (m_shouldProduceT0s) this->CollectAssociated(part, event.m_pfParticleT0Map, m_t0s);
     }
 
+    this->BuildIndexMaps();
+
     // Filter the association maps from the input event to only include objects associated to the selected particles
     this->GetFilteredAssociationMap(
       m_pfParticles, m_spacePoints, event.m_pfParticleSpacePointMap, m_pfParticleSpacePointMap);
@@ -92,24 +95,24 @@ namespace lar_pandora {
     this->WriteCollection(m_pcAxes);
     this->WriteCollection(m_metadata);
 
-    this->WriteAssociation(m_pfParticleSpacePointMap, m_pfParticles, m_spacePoints);
-    this->WriteAssociation(m_pfParticleClusterMap, m_pfParticles, m_clusters);
-    this->WriteAssociation(m_pfParticleVertexMap, m_pfParticles, m_vertices);
-    this->WriteAssociation(m_pfParticleSliceMap, m_pfParticles, m_slices);
-    this->WriteAssociation(m_pfParticleTrackMap, m_pfParticles, m_tracks);
-    this->WriteAssociation(m_pfParticleShowerMap, m_pfParticles, m_showers);
-    this->WriteAssociation(m_pfParticlePCAxisMap, m_pfParticles, m_pcAxes);
-    this->WriteAssociation(m_pfParticleMetadataMap, m_pfParticles, m_metadata);
-    this->WriteAssociation(m_spacePointHitMap, m_spacePoints, m_hits, false);
-    this->WriteAssociation(m_clusterHitMap, m_clusters, m_hits, false);
-    this->WriteAssociation(m_sliceHitMap, m_slices, m_hits, false);
-    this->WriteAssociation(m_trackHitMap, m_tracks, m_hits, false);
-    this->WriteAssociation(m_showerHitMap, m_showers, m_hits, false);
-    this->WriteAssociation(m_showerPCAxisMap, m_showers, m_pcAxes);
+    this->WriteAssociation(m_pfParticleSpacePointMap, m_pfParticleIndices, m_spacePointIndices);
+    this->WriteAssociation(m_pfParticleClusterMap, m_pfParticleIndices, m_clusterIndices);
+    this->WriteAssociation(m_pfParticleVertexMap, m_pfParticleIndices, m_vertexIndices);
+    this->WriteAssociation(m_pfParticleSliceMap, m_pfParticleIndices, m_sliceIndices);
+    this->WriteAssociation(m_pfParticleTrackMap, m_pfParticleIndices, m_trackIndices);
+    this->WriteAssociation(m_pfParticleShowerMap, m_pfParticleIndices, m_showerIndices);
+    this->WriteAssociation(m_pfParticlePCAxisMap, m_pfParticleIndices, m_pcAxisIndices);
+    this->WriteAssociation(m_pfParticleMetadataMap, m_pfParticleIndices, m_metadataIndices);
+    this->WriteAssociation(m_spacePointHitMap, m_spacePointIndices);
+    this->WriteAssociation(m_clusterHitMap, m_clusterIndices);
+    this->WriteAssociation(m_sliceHitMap, m_sliceIndices);
+    this->WriteAssociation(m_trackHitMap, m_trackIndices);
+    this->WriteAssociation(m_showerHitMap, m_showerIndices);
+    this->WriteAssociation(m_showerPCAxisMap, m_showerIndices, m_pcAxisIndices);
 
     if (m_shouldProduceT0s) {
       this->WriteCollection(m_t0s);
-      this->WriteAssociation(m_pfParticleT0Map, m_pfParticles, m_t0s);
+      this->WriteAssociation(m_pfParticleT0Map, m_pfParticleIndices, m_t0Indices);
     }
   }
 
@@ -152,6 +155,23 @@ namespace lar_pandora {
     }
   }
 
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  void LArPandoraEvent::BuildIndexMaps()
+  {
+    this->BuildIndexMap(m_pfParticles, m_pfParticleIndices);
+    this->BuildIndexMap(m_spacePoints, m_spacePointIndices);
+    this->BuildIndexMap(m_clusters, m_clusterIndices);
+    this->BuildIndexMap(m_vertices, m_vertexIndices);
+    this->BuildIndexMap(m_slices, m_sliceIndices);
+    this->BuildIndexMap(m_tracks, m_trackIndices);
+    this->BuildIndexMap(m_showers, m_showerIndices);
+    this->BuildIndexMap(m_pcAxes, m_pcAxisIndices);
+    this->BuildIndexMap(m_metadata, m_metadataIndices);
+
+    if (m_shouldProduceT0s) this->BuildIndexMap(m_t0s, m_t0Indices);
+  }
+
   //------------------------------------------------------------------------------------------------------------------------------------------
   //------------------------------------------------------------------------------------------------------------------------------------------
 
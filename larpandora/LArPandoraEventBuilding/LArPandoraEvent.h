@@ -35,6 +35,7 @@ namespace art {
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility> // std::pair<>
 
 namespace lar_pandora {
@@ -50,6 +51,12 @@ namespace lar_pandora {
     template <typename T>
     using Collection = std::vector<art::Ptr<T>>;
 
+    /**
+     *  @brief Shorthand for a mapping from the objects in a collection of type T to their index in that collection
+     */
+    template <typename T>
+    using IndexMap = std::unordered_map<art::Ptr<T>, size_t>;
+
     template <typename R, typename D>
     using PairVector = std::vector<std::pair<art::Ptr<R>, D>>;
 
@@ -193,11 +200,102 @@ namespace lar_pandora {
     void WriteToEvent() const;
 
   private:
+    friend class LArPandoraEventTestAccess;
+
+    /**
+     *  @brief  Build the mapping from each object to its index in a given collection
+     *
+     *  @param  collection the input collection
+     *  @param  indexMap the output mapping from object to index
+     */
+    template <typename T>
+    static void BuildIndexMap(const Collection<T>& collection, IndexMap<T>& indexMap);
+
+    /**
+     *  @brief  Get the index of an objet in a given collection
+     *
+     *  @param  object the object to search for
+     *  @param  indexMap the mapping from object to index for the collection to search through
+     *
+     *  @return the index of the object in the collection
+     */
+    template <typename T>
+    static size_t GetIndex(const art::Ptr<T>& object, const IndexMap<T>& indexMap);
+
+    /**
+     *  @brief  Fill an output association, where both collections are written by this producer
+     *
+     *  @param  associationMap the association to write from objects of type L -> R + D
+     *  @param  indexMapL the mapping from object to index for the collection of type L that has been written
+     *  @param  indexMapR the mapping from object to index for the collection of type R that has been written
+     *  @param  makePtrL the maker of the output art::Ptrs from an index in the collection of type L, e.g. an art::PtrMaker
+     *  @param  makePtrR the maker of the output art::Ptrs from an index in the collection of type R, e.g. an art::PtrMaker
+     *  @param  outputAssn the output association to fill
+     */
+    template <typename L, typename R, typename D, typename PtrMakerL, typename PtrMakerR>
+    static void FillAssociation(const Association<L, R, D>& associationMap,
+                                const IndexMap<L>& indexMapL,
+                                const IndexMap<R>& indexMapR,
+                                const PtrMakerL& makePtrL,
+                                const PtrMakerR& makePtrR,
+                                art::Assns<L, R, D>& outputAssn);
+
+    /**
+     *  @brief  Fill an output association, where both collections are written by this producer
+     *
+     *  @param  associationMap the association to write from objects of type L -> R (no metadata)
+     *  @param  indexMapL the mapping from object to index for the collection of type L that has been written
+     *  @param  indexMapR the mapping from object to index for the collection of type R that has been written
+     *  @param  makePtrL the maker of the output art::Ptrs from an index in the collection of type L, e.g. an art::PtrMaker
+     *  @param  makePtrR the maker of the output art::Ptrs from an index in the collection of type R, e.g. an art::PtrMaker
+     *  @param  outputAssn the output association to fill
+     */
+    template <typename L, typename R, typename PtrMakerL, typename PtrMakerR>
+    static void FillAssociation(const Association<L, R, void*>& associationMap,
+                                const IndexMap<L>& indexMapL,
+                                const IndexMap<R>& indexMapR,
+                                const PtrMakerL& makePtrL,
+                                const PtrMakerR& makePtrR,
+                                art::Assns<L, R>& outputAssn);
+
+    /**
+     *  @brief  Fill an output association, where the objects of type R were produced by a different module
+     *
+     *  @param  associationMap the association to write from objects of type L -> R + D
+     *  @param  indexMapL the mapping from object to index for the collection of type L that has been written
+     *  @param  makePtrL the maker of the output art::Ptrs from an index in the collection of type L, e.g. an art::PtrMaker
+     *  @param  outputAssn the output association to fill
+     */
+    template <typename L, typename R, typename D, typename PtrMakerL>
+    static void FillAssociation(const Association<L, R, D>& associationMap,
+                                const IndexMap<L>& indexMapL,
+                                const PtrMakerL& makePtrL,
+                                art::Assns<L, R, D>& outputAssn);
+
+    /**
+     *  @brief  Fill an output association, where the objects of type R were produced by a different module
+     *
+     *  @param  associationMap the association to write from objects of type L -> R (no metadata)
+     *  @param  indexMapL the mapping from object to index for the collection of type L that has been written
+     *  @param  makePtrL the maker of the output art::Ptrs from an index in the collection of type L, e.g. an art::PtrMaker
+     *  @param  outputAssn the output association to fill
+     */
+    template <typename L, typename R, typename PtrMakerL>
+    static void FillAssociation(const Association<L, R, void*>& associationMap,
+                                const IndexMap<L>& indexMapL,
+                                const PtrMakerL& makePtrL,
+                                art::Assns<L, R>& outputAssn);
+
     /**
      *  @brief  Get the collections and associations from m_pEvent with the required labels
      */
     void GetCollections();
 
+    /**
+     *  @brief  Build the mappings from each object to its index in the collections that this producer writes
+     */
+    void BuildIndexMaps();
+
     /**
      *  @brief  Gets a given collection from m_pEvent with the label supplied
      *
@@ -268,43 +366,48 @@ namespace lar_pandora {
     void WriteCollection(const Collection<T>& collection) const;
 
     /**
-     *  @brief  Write a given association to the event
+     *  @brief  Write a given association to the event, where both collections are written by this producer
      *
      *  @param  associationMap the association to write from objects of type L -> R + D
-     *  @param  collectionL the collection of type L that has been written
-     *  @param  collectionR the collection of type R that has been written
-     *  @param  thisProducesR will this producer produce collectionR of was it produced by a different module?
+     *  @param  indexMapL the mapping from object to index for the collection of type L that has been written
+     *  @param  indexMapR the mapping from object to index for the collection of type R that has been written
      */
     template <typename L, typename R, typename D>
     void WriteAssociation(const Association<L, R, D>& associationMap,
-                          const Collection<L>& collectionL,
-                          const Collection<R>& collectionR,
-                          const bool thisProducesR = true) const;
+                          const IndexMap<L>& indexMapL,
+                          const IndexMap<R>& indexMapR) const;
 
     /**
-     *  @brief  Write a given association to the event
+     *  @brief  Write a given association to the event, where both collections are written by this producer
      *
      *  @param  associationMap the association to write from objects of type L -> R (no metadata)
-     *  @param  collectionL the collection of type L that has been written
-     *  @param  collectionR the collection of type R that has been written
-     *  @param  thisProducesR will this producer produce collectionR of was it produced by a different module?
+     *  @param  indexMapL the mapping from object to index for the collection of type L that has been written
+     *  @param  indexMapR the mapping from object to index for the collection of type R that has been written
      */
     template <typename L, typename R>
     void WriteAssociation(const Association<L, R, void*>& associationMap,
-                          const Collection<L>& collectionL,
-                          const Collection<R>& collectionR,
-                          const bool thisProducesR = true) const;
+                          const IndexMap<L>& indexMapL,
+                          const IndexMap<R>& indexMapR) const;
 
     /**
-     *  @brief  Get the index of an objet in a given collection
+     *  @brief  Write a given association to the event, where the objects of type R were produced by a different module
      *
-     *  @param  object the object to search for
-     *  @param  collection the collection to search through
+     *  @param  associationMap the association to write from objects of type L -> R + D
+     *  @param  indexMapL the mapping from object to index for the collection of type L that has been written
+     */
+    template <typename L, typename R, typename D>
+    void WriteAssociation(const Association<L, R, D>& associationMap,
+                          const IndexMap<L>& indexMapL) const;
+
+    /**
+     *  @brief  Write a given association to the event, where the objects of type R were produced by a different module
      *
-     *  @return the index of the object in the collection
+     *  @param  associationMap the association to write from objects of type L -> R (no metadata)
+     *  @param  indexMapL the mapping from object to index for the collection of type L that has been written
      */
-    template <typename T>
-    size_t GetIndex(const art::Ptr<T> object, const Collection<T>& collection) const;
+    template <typename L, typename R>
+    void WriteAssociation(const Association<L, R, void*>& associationMap,
+                          const IndexMap<L>& indexMapL) const;
 
     art::EDProducer*
       m_pProducer; ///<  The producer which should write the output collections and associations
@@ -326,6 +429,19 @@ namespace lar_pandora {
     PCAxisCollection m_pcAxes;               ///<  The input collection of PCAxes
     HitCollection m_hits;                    ///<  The input collection of Hits
 
+    // Index maps for the collections written by this producer
+    IndexMap<recob::PFParticle> m_pfParticleIndices; ///<  The indices of the PFParticles
+    IndexMap<recob::SpacePoint> m_spacePointIndices; ///<  The indices of the SpacePoints
+    IndexMap<recob::Cluster> m_clusterIndices;       ///<  The indices of the Clusters
+    IndexMap<recob::Vertex> m_vertexIndices;         ///<  The indices of the Vertices
+    IndexMap<recob::Slice> m_sliceIndices;           ///<  The indices of the Slices
+    IndexMap<recob::Track> m_trackIndices;           ///<  The indices of the Tracks
+    IndexMap<recob::Shower> m_showerIndices;         ///<  The indices of the Showers
+    IndexMap<anab::T0> m_t0Indices;                  ///<  The indices of the T0s
+    IndexMap<larpandoraobj::PFParticleMetadata>
+      m_metadataIndices;                       ///<  The indices of the PFParticle metadata
+    IndexMap<recob::PCAxis> m_pcAxisIndices; ///<  The indices of the PCAxes
+
     // Association maps
     PFParticleToSpacePointAssoc
       m_pfParticleSpacePointMap; ///<  The input associations: PFParticle -> SpacePoint
@@ -352,6 +468,20 @@ namespace lar_pandora {
 
   //------------------------------------------------------------------------------------------------------------------------------------------
 
+  template <typename T>
+  inline void LArPandoraEvent::BuildIndexMap(const Collection<T>& collection,
+                                             IndexMap<T>& indexMap)
+  {
+    indexMap.clear();
+    indexMap.reserve(collection.size());
+
+    // ATTN emplace keeps the first occurrence of any repeated object, as a search through the collection would
+    for (size_t i = 0; i < collection.size(); ++i)
+      indexMap.emplace(collection.at(i), i);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
   template <typename T>
   inline void LArPandoraEvent::GetCollection(const Labels::LabelType& inputLabel,
                                              Collection<T>& outputCollection) const
@@ -474,6 +604,7 @@ namespace lar_pandora {
   inline void LArPandoraEvent::WriteCollection(const Collection<T>& collection) const
   {
     std::unique_ptr<std::vector<T>> output(new std::vector<T>);
+    output->reserve(collection.size());
 
     for (const auto& object : collection)
       output->push_back(*object);
@@ -485,9 +616,8 @@ namespace lar_pandora {
 
   template <typename L, typename R, typename D>
   inline void LArPandoraEvent::WriteAssociation(const Association<L, R, D>& associationMap,
-                                                const Collection<L>& collectionL,
-                                                const Collection<R>& collectionR,
-                                                const bool thisProducesR) const
+                                                const IndexMap<L>& indexMapL,
+                                                const IndexMap<R>& indexMapR) const
   {
     // The output assocation to populate
     std::unique_ptr<art::Assns<L, R, D>> outputAssn(new art::Assns<L, R, D>);
@@ -496,25 +626,10 @@ namespace lar_pandora {
     // correct associations, we need to make new art::Ptrs to refer to the *copies* of the objects made by this producer. This is done using
     // the PtrMaker utility.
     const art::PtrMaker<L> makePtrL(*m_pEvent);
+    const art::PtrMaker<R> makePtrR(*m_pEvent);
 
-    for (auto it = associationMap.begin(); it != associationMap.end(); ++it) {
-      const auto indexL(this->GetIndex(it->first, collectionL));
-      const auto outputPtrL(makePtrL(indexL));
-
-      for (const auto& entry : it->second) {
-        const auto& objectR(entry.first);
-        const auto& objectD(entry.second);
-
-        if (thisProducesR) {
-          const art::PtrMaker<R> makePtrR(*m_pEvent);
-          const auto indexR(this->GetIndex(objectR, collectionR));
-          outputAssn->addSingle(outputPtrL, makePtrR(indexR), objectD);
-        }
-        else {
-          outputAssn->addSingle(outputPtrL, objectR, objectD);
-        }
-      }
-    }
+    LArPandoraEvent::FillAssociation(
+      associationMap, indexMapL, indexMapR, makePtrL, makePtrR, *outputAssn);
 
     m_pEvent->put(std::move(outputAssn));
   }
@@ -523,9 +638,8 @@ namespace lar_pandora {
 
   template <typename L, typename R>
   inline void LArPandoraEvent::WriteAssociation(const Association<L, R, void*>& associationMap,
-                                                const Collection<L>& collectionL,
-                                                const Collection<R>& collectionR,
-                                                const bool thisProducesR) const
+                                                const IndexMap<L>& indexMapL,
+                                                const IndexMap<R>& indexMapR) const
   {
     // The output assocation to populate
     std::unique_ptr<art::Assns<L, R>> outputAssn(new art::Assns<L, R>);
@@ -534,41 +648,130 @@ namespace lar_pandora {
     // correct associations, we need to make new art::Ptrs to refer to the *copies* of the objects made by this producer. This is done using
     // the PtrMaker utility.
     const art::PtrMaker<L> makePtrL(*m_pEvent);
+    const art::PtrMaker<R> makePtrR(*m_pEvent);
+
+    LArPandoraEvent::FillAssociation(
+      associationMap, indexMapL, indexMapR, makePtrL, makePtrR, *outputAssn);
+
+    m_pEvent->put(std::move(outputAssn));
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  template <typename L, typename R, typename D>
+  inline void LArPandoraEvent::WriteAssociation(const Association<L, R, D>& associationMap,
+                                                const IndexMap<L>& indexMapL) const
+  {
+    // The output assocation to populate
+    std::unique_ptr<art::Assns<L, R, D>> outputAssn(new art::Assns<L, R, D>);
+
+    // NB. Only the objects of type L are copies made by this producer, the objects of type R keep their original art::Ptrs
+    const art::PtrMaker<L> makePtrL(*m_pEvent);
 
+    LArPandoraEvent::FillAssociation(associationMap, indexMapL, makePtrL, *outputAssn);
+
+    m_pEvent->put(std::move(outputAssn));
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  template <typename L, typename R>
+  inline void LArPandoraEvent::WriteAssociation(const Association<L, R, void*>& associationMap,
+                                                const IndexMap<L>& indexMapL) const
+  {
+    // The output assocation to populate
+    std::unique_ptr<art::Assns<L, R>> outputAssn(new art::Assns<L, R>);
+
+    // NB. Only the objects of type L are copies made by this producer, the objects of type R keep their original art::Ptrs
+    const art::PtrMaker<L> makePtrL(*m_pEvent);
+
+    LArPandoraEvent::FillAssociation(associationMap, indexMapL, makePtrL, *outputAssn);
+
+    m_pEvent->put(std::move(outputAssn));
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  template <typename L, typename R, typename D, typename PtrMakerL, typename PtrMakerR>
+  inline void LArPandoraEvent::FillAssociation(const Association<L, R, D>& associationMap,
+                                               const IndexMap<L>& indexMapL,
+                                               const IndexMap<R>& indexMapR,
+                                               const PtrMakerL& makePtrL,
+                                               const PtrMakerR& makePtrR,
+                                               art::Assns<L, R, D>& outputAssn)
+  {
     for (auto it = associationMap.begin(); it != associationMap.end(); ++it) {
-      const auto indexL(this->GetIndex(it->first, collectionL));
-      const auto outputPtrL(makePtrL(indexL));
-
-      for (const auto& entry : it->second) {
-        const auto& objectR(entry.first);
-
-        if (thisProducesR) {
-          const art::PtrMaker<R> makePtrR(*m_pEvent);
-          const auto indexR(this->GetIndex(objectR, collectionR));
-          outputAssn->addSingle(outputPtrL, makePtrR(indexR));
-        }
-        else {
-          outputAssn->addSingle(outputPtrL, objectR);
-        }
-      }
+      const auto outputPtrL(makePtrL(LArPandoraEvent::GetIndex(it->first, indexMapL)));
+
+      for (const auto& entry : it->second)
+        outputAssn.addSingle(
+          outputPtrL, makePtrR(LArPandoraEvent::GetIndex(entry.first, indexMapR)), entry.second);
     }
+  }
 
-    m_pEvent->put(std::move(outputAssn));
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  template <typename L, typename R, typename PtrMakerL, typename PtrMakerR>
+  inline void LArPandoraEvent::FillAssociation(const Association<L, R, void*>& associationMap,
+                                               const IndexMap<L>& indexMapL,
+                                               const IndexMap<R>& indexMapR,
+                                               const PtrMakerL& makePtrL,
+                                               const PtrMakerR& makePtrR,
+                                               art::Assns<L, R>& outputAssn)
+  {
+    for (auto it = associationMap.begin(); it != associationMap.end(); ++it) {
+      const auto outputPtrL(makePtrL(LArPandoraEvent::GetIndex(it->first, indexMapL)));
+
+      for (const auto& entry : it->second)
+        outputAssn.addSingle(outputPtrL,
+                             makePtrR(LArPandoraEvent::GetIndex(entry.first, indexMapR)));
+    }
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  template <typename L, typename R, typename D, typename PtrMakerL>
+  inline void LArPandoraEvent::FillAssociation(const Association<L, R, D>& associationMap,
+                                               const IndexMap<L>& indexMapL,
+                                               const PtrMakerL& makePtrL,
+                                               art::Assns<L, R, D>& outputAssn)
+  {
+    for (auto it = associationMap.begin(); it != associationMap.end(); ++it) {
+      const auto outputPtrL(makePtrL(LArPandoraEvent::GetIndex(it->first, indexMapL)));
+
+      for (const auto& entry : it->second)
+        outputAssn.addSingle(outputPtrL, entry.first, entry.second);
+    }
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  template <typename L, typename R, typename PtrMakerL>
+  inline void LArPandoraEvent::FillAssociation(const Association<L, R, void*>& associationMap,
+                                               const IndexMap<L>& indexMapL,
+                                               const PtrMakerL& makePtrL,
+                                               art::Assns<L, R>& outputAssn)
+  {
+    for (auto it = associationMap.begin(); it != associationMap.end(); ++it) {
+      const auto outputPtrL(makePtrL(LArPandoraEvent::GetIndex(it->first, indexMapL)));
+
+      for (const auto& entry : it->second)
+        outputAssn.addSingle(outputPtrL, entry.first);
+    }
   }
 
   //------------------------------------------------------------------------------------------------------------------------------------------
 
   template <typename T>
-  inline size_t LArPandoraEvent::GetIndex(const art::Ptr<T> object,
-                                          const Collection<T>& collection) const
+  inline size_t LArPandoraEvent::GetIndex(const art::Ptr<T>& object, const IndexMap<T>& indexMap)
   {
-    const auto it(std::find(collection.begin(), collection.end(), object));
-    if (it == collection.end())
+    const auto it(indexMap.find(object));
+    if (it == indexMap.end())
       throw cet::exception("LArPandora")
         << " LArPandoraEvent::GetIndex -- Can't find input object in the supplied collection."
         << std::endl;
 
-    return static_cast<size_t>(std::distance(collection.begin(), it));
+    return it->second;
   }
 
 } // namespace lar_pandora
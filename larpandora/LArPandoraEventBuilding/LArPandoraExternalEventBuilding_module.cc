@@ -26,6 +26,11 @@
 
 #include "TTree.h"
 
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+
 namespace lar_pandora {
 
   class LArPandoraExternalEventBuilding : public art::EDProducer {
@@ -40,53 +45,65 @@ namespace lar_pandora {
     void produce(art::Event& evt) override;
 
   private:
-    typedef std::map<art::Ptr<recob::PFParticle>, art::Ptr<larpandoraobj::PFParticleMetadata>>
-      PFParticleToMetadata;
+    /**
+     *  @brief  Flat description of the PFParticle hierarchy, built once per event and indexed by PFParticle art::Ptr key
+     */
+    struct HierarchyIndex {
+      std::vector<size_t> m_parentKeys; ///< The key of the top-level parent of each PFParticle
+      std::vector<size_t> m_topLevelKeys; ///< The keys of the top-level PFParticles, in key order
+      std::vector<bool>
+        m_isClearCosmic; ///< Whether each PFParticle belongs to a clear cosmic-ray hierarchy
+      std::vector<bool> m_isTarget; ///< Whether each PFParticle belongs to a target hypothesis
+      std::vector<size_t>
+        m_sliceIndices; ///< The slice index of each PFParticle that is not a clear cosmic ray
+      std::vector<unsigned int>
+        m_sliceIds; ///< The distinct slice ids of the PFParticles that are not clear cosmic rays, in ascending order
+      std::vector<float> m_sliceTargetScores; ///< The target score of each slice
+    };
 
     /**
      *  @brief  Collect PFParticles from the ART event and their mapping to metadata objects
      *
      *  @param  evt the ART event
-     *  @param  particlesToMetadata the output mapping from PFParticles to their metadata
-     *  @param  particles the output vector of particles
+     *  @param  particles the output vector of particles, such that the position of each particle is its art::Ptr key
+     *  @param  particleMetadata the output vector of metadata for each particle, indexed by art::Ptr key
      */
     void CollectPFParticles(const art::Event& evt,
-                            PFParticleToMetadata& particlesToMetadata,
-                            PFParticleVector& particles) const;
+                            PFParticleVector& particles,
+                            MetadataVector& particleMetadata) const;
 
     /**
-     *  @brief  Build mapping from ID to PFParticle for fast navigation through the hierarchy
+     *  @brief  Navigate the PFParticle hierarchy once, record the top-level parent, slice and hypothesis of each particle,
+     *          and build the table of slice ids and target scores
      *
-     *  @param  particlesToMetadata the input mapping from PFParticles to their metadata
-     *  @param  particleMap the output mapping from ID to PFParticle
+     *  @param  allParticles input vector of all particles
+     *  @param  particleMetadata the input vector of metadata for each particle
+     *  @param  hierarchyIndex the output hierarchy index
      */
-    void BuildPFParticleMap(const PFParticleToMetadata& particlesToMetadata,
-                            PFParticleMap& particleMap) const;
+    void BuildHierarchyIndex(const PFParticleVector& allParticles,
+                             const MetadataVector& particleMetadata,
+                             HierarchyIndex& hierarchyIndex) const;
 
     /**
      *  @brief  Collect PFParticles that have been identified as clear cosmic ray muons by pandora
      *
      *  @param  allParticles input vector of all particles
-     *  @param  particlesToMetadata the input mapping from PFParticles to their metadata
-     *  @param  particleMap the input mapping from ID to PFParticle
+     *  @param  hierarchyIndex the input hierarchy index
      *  @param  clearCosmics the output vector of clear cosmic rays
      */
     void CollectClearCosmicRays(const PFParticleVector& allParticles,
-                                const PFParticleToMetadata& particlesToMetadata,
-                                const PFParticleMap& particleMap,
+                                const HierarchyIndex& hierarchyIndex,
                                 PFParticleVector& clearCosmics) const;
 
     /**
      *  @brief  Collect slices
      *
      *  @param  allParticles input vector of all particles
-     *  @param  particlesToMetadata the input mapping from PFParticles to their metadata
-     *  @param  particleMap the input mapping from ID to PFParticle
+     *  @param  hierarchyIndex the input hierarchy index
      *  @param  slices the output vector of slices
      */
     void CollectSlices(const PFParticleVector& allParticles,
-                       const PFParticleToMetadata& particlesToMetadata,
-                       const PFParticleMap& particleMap,
+                       const HierarchyIndex& hierarchyIndex,
                        SliceVector& slices) const;
 
     /**
@@ -102,6 +119,18 @@ namespace lar_pandora {
                                       const SliceVector& slices,
                                       PFParticleVector& consolidatedParticles) const;
 
+    /**
+     *  @brief  Query a metadata object for a given key, without throwing if the key is absent
+     *
+     *  @param  metadata the metadata object to query
+     *  @param  key the key to search for
+     *
+     *  @return the value in the metadata corresponding to the input key, if present
+     */
+    std::optional<float> FindMetadataValue(
+      const art::Ptr<larpandoraobj::PFParticleMetadata>& metadata,
+      const std::string& key) const;
+
     /**
      *  @brief  Query a metadata object for a given key and return the corresponding value
      *
@@ -137,6 +166,9 @@ namespace lar_pandora {
     bool m_useTestBeamMode;  ///< If we should expect a test-beam (instead of a neutrino) slice
     std::string m_targetKey; ///< The metadata key for a PFParticle to determine if it is the target
     std::string m_scoreKey;  ///< The metadata key for the score of the target slice from Pandora
+    std::string
+      m_clearCosmicKey; ///< The metadata key for a PFParticle to determine if it is a clear cosmic
+    std::string m_sliceIndexKey; ///< The metadata key for the slice index of a PFParticle
   };
 
   DEFINE_ART_MODULE(LArPandoraExternalEventBuilding)
@@ -162,6 +194,8 @@ namespace lar_pandora {
     , m_useTestBeamMode(pset.get<bool>("ShouldUseTestBeamMode", false))
     , m_targetKey(m_useTestBeamMode ? "IsTestBeam" : "IsNeutrino")
     , m_scoreKey(m_useTestBeamMode ? "TestBeamScore" : "NuScore")
+    , m_clearCosmicKey("IsClearCosmic")
+    , m_sliceIndexKey("SliceIndex")
   {
     produces<std::vector<recob::PFParticle>>();
     produces<std::vector<recob::SpacePoint>>();
@@ -199,17 +233,17 @@ namespace lar_pandora {
   void LArPandoraExternalEventBuilding::produce(art::Event& evt)
   {
     PFParticleVector particles;
-    PFParticleToMetadata particlesToMetadata;
-    this->CollectPFParticles(evt, particlesToMetadata, particles);
+    MetadataVector particleMetadata;
+    this->CollectPFParticles(evt, particles, particleMetadata);
 
-    PFParticleMap particleMap;
-    this->BuildPFParticleMap(particlesToMetadata, particleMap);
+    HierarchyIndex hierarchyIndex;
+    this->BuildHierarchyIndex(particles, particleMetadata, hierarchyIndex);
 
     PFParticleVector clearCosmics;
-    this->CollectClearCosmicRays(particles, particlesToMetadata, particleMap, clearCosmics);
+    this->CollectClearCosmicRays(particles, hierarchyIndex, clearCosmics);
 
     SliceVector slices;
-    this->CollectSlices(particles, particlesToMetadata, particleMap, slices);
+    this->CollectSlices(particles, hierarchyIndex, slices);
 
     m_sliceIdTool->ClassifySlices(slices, evt);
 
@@ -226,10 +260,9 @@ namespace lar_pandora {
 
   //------------------------------------------------------------------------------------------------------------------------------------------
 
-  void LArPandoraExternalEventBuilding::CollectPFParticles(
-    const art::Event& evt,
-    PFParticleToMetadata& particlesToMetadata,
-    PFParticleVector& particles) const
+  void LArPandoraExternalEventBuilding::CollectPFParticles(const art::Event& evt,
+                                                           PFParticleVector& particles,
+                                                           MetadataVector& particleMetadata) const
   {
     art::Handle<std::vector<recob::PFParticle>> pfParticleHandle;
     evt.getByLabel(m_pandoraTag, pfParticleHandle);
@@ -237,144 +270,184 @@ namespace lar_pandora {
     art::FindManyP<larpandoraobj::PFParticleMetadata> pfParticleMetadataAssoc(
       pfParticleHandle, evt, m_pandoraTag);
 
+    particles.reserve(pfParticleHandle->size());
+    particleMetadata.reserve(pfParticleHandle->size());
+
     for (unsigned int i = 0; i < pfParticleHandle->size(); ++i) {
       const art::Ptr<recob::PFParticle> part(pfParticleHandle, i);
       const auto& metadata(pfParticleMetadataAssoc.at(part.key()));
 
-      particles.push_back(part);
-
       if (metadata.size() != 1)
         throw cet::exception("LArPandora")
           << " LArPandoraExternalEventBuilding::CollectPFParticles -- Found a PFParticle without "
              "exactly 1 metadata associated."
           << std::endl;
 
-      if (!particlesToMetadata.insert(PFParticleToMetadata::value_type(part, metadata.front()))
-             .second)
-        throw cet::exception("LArPandoraExternalEventBuilding")
-          << "Repeated PFParticles" << std::endl;
+      particles.push_back(part);
+      particleMetadata.push_back(metadata.front());
     }
   }
 
   //------------------------------------------------------------------------------------------------------------------------------------------
 
-  void LArPandoraExternalEventBuilding::BuildPFParticleMap(
-    const PFParticleToMetadata& particlesToMetadata,
-    PFParticleMap& particleMap) const
+  void LArPandoraExternalEventBuilding::BuildHierarchyIndex(const PFParticleVector& allParticles,
+                                                            const MetadataVector& particleMetadata,
+                                                            HierarchyIndex& hierarchyIndex) const
   {
-    for (const auto& entry : particlesToMetadata) {
-      if (!particleMap.insert(PFParticleMap::value_type(entry.first->Self(), entry.first)).second)
+    const size_t nParticles(allParticles.size());
+
+    std::unordered_map<size_t, size_t> selfToKey;
+    selfToKey.reserve(nParticles);
+
+    for (const auto& part : allParticles) {
+      if (!selfToKey.emplace(part->Self(), part.key()).second)
         throw cet::exception("LArPandoraExternalEventBuilding")
           << "Repeated PFParticles" << std::endl;
     }
-  }
 
-  //------------------------------------------------------------------------------------------------------------------------------------------
+    // Find the top-level parent of each particle, remembering the answer for every particle visited on the way up
+    const size_t unassigned(std::numeric_limits<size_t>::max());
+    auto& parentKeys(hierarchyIndex.m_parentKeys);
+    parentKeys.assign(nParticles, unassigned);
 
-  void LArPandoraExternalEventBuilding::CollectClearCosmicRays(
-    const PFParticleVector& allParticles,
-    const PFParticleToMetadata& particlesToMetadata,
-    const PFParticleMap& particleMap,
-    PFParticleVector& clearCosmics) const
-  {
+    std::vector<size_t> visitedKeys;
     for (const auto& part : allParticles) {
-      // Get the parent of the particle
-      const auto parentIt(
-        particlesToMetadata.find(LArPandoraHelper::GetParentPFParticle(particleMap, part)));
-      if (parentIt == particlesToMetadata.end())
-        throw cet::exception("LArPandoraExternalEventBuilding")
-          << "Found PFParticle without metadata" << std::endl;
+      size_t key(part.key());
+      visitedKeys.clear();
+
+      while (parentKeys.at(key) == unassigned) {
+        const art::Ptr<recob::PFParticle>& current(allParticles.at(key));
+        if (current->IsPrimary()) {
+          parentKeys.at(key) = key;
+          break;
+        }
+
+        visitedKeys.push_back(key);
+
+        const auto parentIt(selfToKey.find(current->Parent()));
+        if (parentIt == selfToKey.end())
+          throw cet::exception("LArPandoraExternalEventBuilding")
+            << "Found a PFParticle without a parent particle" << std::endl;
+
+        key = parentIt->second;
+      }
+
+      for (const size_t visitedKey : visitedKeys)
+        parentKeys.at(visitedKey) = parentKeys.at(key);
+    }
+
+    // Query the metadata of each top-level parent once, and share the result with its hierarchy
+    hierarchyIndex.m_isClearCosmic.assign(nParticles, false);
+    hierarchyIndex.m_isTarget.assign(nParticles, false);
+
+    for (size_t key = 0; key < nParticles; ++key) {
+      if (parentKeys.at(key) == key) hierarchyIndex.m_topLevelKeys.push_back(key);
+    }
+
+    std::vector<unsigned int> topLevelSliceIds(nParticles, 0);
+    std::vector<float> topLevelTargetScores(nParticles, 0.f);
+    auto& sliceIds(hierarchyIndex.m_sliceIds);
+
+    for (const size_t key : hierarchyIndex.m_topLevelKeys) {
+      const art::Ptr<larpandoraobj::PFParticleMetadata>& metadata(particleMetadata.at(key));
 
       // ATTN particles without the "IsClearCosmic" parameter are not clear cosmics
-      try {
-        if (static_cast<bool>(
-              std::round(this->GetMetadataValue(parentIt->second, "IsClearCosmic"))))
-          clearCosmics.push_back(part);
+      if (static_cast<bool>(
+            std::round(this->FindMetadataValue(metadata, m_clearCosmicKey).value_or(0.f)))) {
+        hierarchyIndex.m_isClearCosmic.at(key) = true;
+        continue;
       }
-      catch (const cet::exception&) {
+
+      topLevelSliceIds.at(key) =
+        static_cast<unsigned int>(std::round(this->GetMetadataValue(metadata, m_sliceIndexKey)));
+      topLevelTargetScores.at(key) = this->GetMetadataValue(metadata, m_scoreKey);
+      hierarchyIndex.m_isTarget.at(key) = this->IsTarget(metadata);
+      sliceIds.push_back(topLevelSliceIds.at(key));
+    }
+
+    // Sort the slice ids to ensure reproducibility
+    std::sort(sliceIds.begin(), sliceIds.end());
+    sliceIds.erase(std::unique(sliceIds.begin(), sliceIds.end()), sliceIds.end());
+
+    // ATTN all PFParticles in the same slice will have the same target score, take it from the first of them
+    const size_t noSlice(std::numeric_limits<size_t>::max());
+    hierarchyIndex.m_sliceIndices.assign(nParticles, noSlice);
+    hierarchyIndex.m_sliceTargetScores.assign(sliceIds.size(), 0.f);
+    std::vector<bool> hasTargetScore(sliceIds.size(), false);
+
+    for (size_t key = 0; key < nParticles; ++key) {
+      const size_t parentKey(parentKeys.at(key));
+      hierarchyIndex.m_isClearCosmic.at(key) = hierarchyIndex.m_isClearCosmic.at(parentKey);
+      if (hierarchyIndex.m_isClearCosmic.at(key)) continue;
+
+      hierarchyIndex.m_isTarget.at(key) = hierarchyIndex.m_isTarget.at(parentKey);
+
+      const size_t sliceIndex(
+        std::lower_bound(sliceIds.begin(), sliceIds.end(), topLevelSliceIds.at(parentKey)) -
+        sliceIds.begin());
+      hierarchyIndex.m_sliceIndices.at(key) = sliceIndex;
+
+      if (!hasTargetScore.at(sliceIndex)) {
+        hierarchyIndex.m_sliceTargetScores.at(sliceIndex) = topLevelTargetScores.at(parentKey);
+        hasTargetScore.at(sliceIndex) = true;
       }
     }
   }
 
   //------------------------------------------------------------------------------------------------------------------------------------------
 
-  void LArPandoraExternalEventBuilding::CollectSlices(
-    const PFParticleVector& allParticles,
-    const PFParticleToMetadata& particlesToMetadata,
-    const PFParticleMap& particleMap,
-    SliceVector& slices) const
+  void LArPandoraExternalEventBuilding::CollectClearCosmicRays(const PFParticleVector& allParticles,
+                                                               const HierarchyIndex& hierarchyIndex,
+                                                               PFParticleVector& clearCosmics) const
   {
-    std::map<unsigned int, float> targetScores;
-    std::map<unsigned int, PFParticleVector> crHypotheses;
-    std::map<unsigned int, PFParticleVector> targetHypotheses;
-    std::vector<unsigned int> usedSliceIds;
-
-    // Collect the slice information
     for (const auto& part : allParticles) {
-      // Find the parent PFParticle
-      const auto parentIt(
-        particlesToMetadata.find(LArPandoraHelper::GetParentPFParticle(particleMap, part)));
-      if (parentIt == particlesToMetadata.end())
-        throw cet::exception("LArPandoraExternalEventBuilding")
-          << "Found PFParticle without metadata" << std::endl;
+      if (hierarchyIndex.m_isClearCosmic.at(part.key())) clearCosmics.push_back(part);
+    }
+  }
 
-      // Skip PFParticles that are clear cosmics
-      try {
-        if (static_cast<bool>(
-              std::round(this->GetMetadataValue(parentIt->second, "IsClearCosmic"))))
-          continue;
-      }
-      catch (const cet::exception&) {
-      }
+  //------------------------------------------------------------------------------------------------------------------------------------------
 
-      const unsigned int sliceId(static_cast<unsigned int>(
-        std::round(this->GetMetadataValue(parentIt->second, "SliceIndex"))));
-      const float targetScore(this->GetMetadataValue(parentIt->second, m_scoreKey));
+  void LArPandoraExternalEventBuilding::CollectSlices(const PFParticleVector& allParticles,
+                                                      const HierarchyIndex& hierarchyIndex,
+                                                      SliceVector& slices) const
+  {
+    // ATTN: we need to ensure that for each slice there is a cosmic and neutrino hypothesis, even if the pass created no PFOs
+    // in such a case the hypothesis is left as an empty vector of pfparticles
+    const size_t nSlices(hierarchyIndex.m_sliceIds.size());
+    std::vector<PFParticleVector> targetHypotheses(nSlices), crHypotheses(nSlices);
 
-      // Keep track of the slice IDs we have used, and their corresponding score
-      if (std::find(usedSliceIds.begin(), usedSliceIds.end(), sliceId) == usedSliceIds.end()) {
-        usedSliceIds.push_back(sliceId);
+    for (const auto& part : allParticles) {
+      const size_t key(part.key());
+      if (hierarchyIndex.m_isClearCosmic.at(key)) continue;
 
-        // ATTN all PFParticles in the same slice will have the same targetScore
-        targetScores[sliceId] = targetScore;
-      }
+      const size_t sliceIndex(hierarchyIndex.m_sliceIndices.at(key));
 
-      if (this->IsTarget(parentIt->second)) { targetHypotheses[sliceId].push_back(part); }
+      if (hierarchyIndex.m_isTarget.at(key)) { targetHypotheses.at(sliceIndex).push_back(part); }
       else {
-        crHypotheses[sliceId].push_back(part);
+        crHypotheses.at(sliceIndex).push_back(part);
       }
     }
 
-    // Sort the slice IDs to ensure reproducibility
-    std::sort(usedSliceIds.begin(), usedSliceIds.end());
-
-    // ATTN: we need to ensure that for each slice there is a cosmic and neutrino hypothesis, even if the pass created no PFOs
-    // in such a case we add an empty vector of pfparticles
-    const PFParticleVector emptyPFParticleVector;
-
     // Produce the slices
-    for (const unsigned int sliceId : usedSliceIds) {
-      // Get the target score
-      const auto targetScoresIter(targetScores.find(sliceId));
-      if (targetScoresIter == targetScores.end())
-        throw cet::exception("LArPandoraExternalEventBuilding")
-          << "Scrambled slice information - can't find target score with id = " << sliceId
-          << std::endl;
+    slices.reserve(slices.size() + nSlices);
+    for (size_t sliceIndex = 0; sliceIndex < nSlices; ++sliceIndex)
+      slices.emplace_back(hierarchyIndex.m_sliceTargetScores.at(sliceIndex),
+                          targetHypotheses.at(sliceIndex),
+                          crHypotheses.at(sliceIndex));
+  }
 
-      PFParticleVector targetPFParticleVector, crPFParticleVector;
+  //------------------------------------------------------------------------------------------------------------------------------------------
 
-      // Get the target hypothesis
-      const auto targetHypothesisIter(targetHypotheses.find(sliceId));
-      targetPFParticleVector =
-        ((targetHypothesisIter == targetHypotheses.end()) ? emptyPFParticleVector :
-                                                            targetHypothesisIter->second);
+  std::optional<float> LArPandoraExternalEventBuilding::FindMetadataValue(
+    const art::Ptr<larpandoraobj::PFParticleMetadata>& metadata,
+    const std::string& key) const
+  {
+    const auto& propertiesMap(metadata->GetPropertiesMap());
+    const auto& it(propertiesMap.find(key));
 
-      // Get the cosmic hypothesis
-      const auto crHypothesisIter(crHypotheses.find(sliceId));
-      crPFParticleVector = ((crHypothesisIter == crHypotheses.end()) ? emptyPFParticleVector :
-                                                                       crHypothesisIter->second);
-      slices.emplace_back(targetScoresIter->second, targetPFParticleVector, crPFParticleVector);
-    }
+    if (it == propertiesMap.end()) return std::nullopt;
+
+    return it->second;
   }
 
   //------------------------------------------------------------------------------------------------------------------------------------------
@@ -383,14 +456,13 @@ namespace lar_pandora {
     const art::Ptr<larpandoraobj::PFParticleMetadata>& metadata,
     const std::string& key) const
   {
-    const auto& propertiesMap(metadata->GetPropertiesMap());
-    const auto& it(propertiesMap.find(key));
+    const std::optional<float> value(this->FindMetadataValue(metadata, key));
 
-    if (it == propertiesMap.end())
+    if (!value)
       throw cet::exception("LArPandoraExternalEventBuilding")
         << "No key \"" << key << "\" found in metadata properties map" << std::endl;
 
-    return it->second;
+    return *value;
   }
 
   //------------------------------------------------------------------------------------------------------------------------------------------
@@ -401,21 +473,22 @@ namespace lar_pandora {
     const SliceVector& slices,
     PFParticleVector& consolidatedParticles) const
   {
-    PFParticleVector collectedParticles;
-    collectedParticles.insert(collectedParticles.end(), clearCosmics.begin(), clearCosmics.end());
+    std::vector<bool> isCollected(allParticles.size(), false);
+
+    for (const auto& part : clearCosmics)
+      isCollected.at(part.key()) = true;
 
     for (const auto& slice : slices) {
       const PFParticleVector& particles(slice.IsTaggedAsTarget() ? slice.GetTargetHypothesis() :
                                                                    slice.GetCosmicRayHypothesis());
-      collectedParticles.insert(collectedParticles.end(), particles.begin(), particles.end());
+      for (const auto& part : particles)
+        isCollected.at(part.key()) = true;
     }
 
     // ATTN the collected particles are the ones we want to output, but here we loop over all particles to ensure that the consolidated
     // particles have the same ordering.
     for (const auto& part : allParticles) {
-      if (std::find(collectedParticles.begin(), collectedParticles.end(), part) !=
-          collectedParticles.end())
-        consolidatedParticles.push_back(part);
+      if (isCollected.at(part.key())) consolidatedParticles.push_back(part);
     }
   }
 
@@ -424,12 +497,9 @@ namespace lar_pandora {
   bool LArPandoraExternalEventBuilding::IsTarget(
     const art::Ptr<larpandoraobj::PFParticleMetadata>& metadata) const
   {
-    try {
-      return static_cast<bool>(std::round(this->GetMetadataValue(metadata, m_targetKey)));
-    }
-    catch (const cet::exception&) {
-      return false;
-    }
+    // ATTN particles without the target parameter are not targets
+    return static_cast<bool>(
+      std::round(this->FindMetadataValue(metadata, m_targetKey).value_or(0.f)));
   }
 
 } // namespace lar_pandora
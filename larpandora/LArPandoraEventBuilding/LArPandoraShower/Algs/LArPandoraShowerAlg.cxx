@@ -1,9 +1,12 @@
 #include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Algs/LArPandoraShowerAlg.h"
+#include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Algs/ShowerCalibratedHitTable.h"
 #include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Algs/ShowerElementHolder.hh"
+#include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Algs/ShowerSpacePointGrid.h"
 
 #include "larcore/CoreUtils/ServiceUtil.h"
 #include "lardataalg/DetectorInfo/DetectorClocksData.h"
 #include "lardataalg/DetectorInfo/DetectorPropertiesData.h"
+#include "lardataobj/RecoBase/Cluster.h"
 #include "lardataobj/RecoBase/Hit.h"
 #include "lardataobj/RecoBase/PFParticle.h"
 #include "lardataobj/RecoBase/SpacePoint.h"
@@ -26,6 +29,7 @@ shower::LArPandoraShowerAlg::LArPandoraShowerAlg(const fhicl::ParameterSet& pset
   : fUseCollectionOnly(pset.get<bool>("UseCollectionOnly"))
   , fPFParticleLabel(pset.get<art::InputTag>("PFParticleLabel"))
   , fSCEXFlip(pset.get<bool>("SCEXFlip"))
+  , fSpacePointGridCellSize(pset.get<double>("SpacePointGridCellSize"))
   , fSCE(lar::providerFrom<spacecharge::SpaceChargeService>())
   , fInitialTrackInputLabel(pset.get<std::string>("InitialTrackInputLabel"))
   , fShowerStartPositionInputLabel(pset.get<std::string>("ShowerStartPositionInputLabel"))
@@ -599,6 +603,61 @@ shower::LArPandoraShowerAlg::OrganizeHits(const std::vector<art::Ptr<recob::Hit>
   return ret;
 }
 
+const shower::ShowerSpacePointGrid& shower::LArPandoraShowerAlg::GetSpacePointGrid(
+  art::Ptr<recob::PFParticle> const& pfparticle,
+  art::Event const& Event,
+  art::InputTag const& pfParticleLabel,
+  reco::shower::ShowerElementHolder& ShowerEleHolder) const
+{
+  const std::string name("SpacePointGrid_" + pfParticleLabel.label() + "_" +
+                         std::to_string(pfparticle.key()));
+
+  if (ShowerEleHolder.CheckEventElement(name)) {
+    return ShowerEleHolder.GetEventElement<shower::ShowerSpacePointGrid>(name);
+  }
+
+  auto const pfpHandle = Event.getValidHandle<std::vector<recob::PFParticle>>(pfParticleLabel);
+  const art::FindManyP<recob::SpacePoint>& fmspp =
+    ShowerEleHolder.GetFindManyP<recob::SpacePoint>(pfpHandle, Event, pfParticleLabel);
+
+  shower::ShowerSpacePointGrid grid(fmspp.at(pfparticle.key()), fSpacePointGridCellSize);
+  ShowerEleHolder.SetEventElement(grid, name);
+  return ShowerEleHolder.GetEventElement<shower::ShowerSpacePointGrid>(name);
+}
+
+const shower::ShowerCalibratedHitTable& shower::LArPandoraShowerAlg::GetCalibratedHitTable(
+  art::Event const& Event,
+  art::InputTag const& pfParticleLabel,
+  detinfo::DetectorClocksData const& clockData,
+  detinfo::DetectorPropertiesData const& detProp,
+  calo::CalorimetryAlg const& calorimetryAlg,
+  fhicl::ParameterSetID const& calorimetryAlgID,
+  reco::shower::ShowerElementHolder& ShowerEleHolder) const
+{
+  //The corrections depend on the CalorimetryAlg configuration, so it is part of the name
+  const std::string name("CalibratedHitTable_" + pfParticleLabel.label() + "_" +
+                         calorimetryAlgID.to_string());
+
+  if (ShowerEleHolder.CheckEventElement(name)) {
+    return ShowerEleHolder.GetEventElement<shower::ShowerCalibratedHitTable>(name);
+  }
+
+  //Take the hits of all the clusters, so every shower in the event reads from the same table
+  auto const clusHandle = Event.getValidHandle<std::vector<recob::Cluster>>(pfParticleLabel);
+  const art::FindManyP<recob::Hit>& fmhc =
+    ShowerEleHolder.GetFindManyP<recob::Hit>(clusHandle, Event, pfParticleLabel);
+
+  std::vector<art::Ptr<recob::Hit>> hits;
+  for (size_t cluster = 0; cluster < clusHandle->size(); ++cluster) {
+    auto const& clusterHits = fmhc.at(cluster);
+    hits.insert(hits.end(), clusterHits.begin(), clusterHits.end());
+  }
+
+  shower::ShowerCalibratedHitTable table(hits, clockData, detProp, calorimetryAlg);
+  ShowerEleHolder.SetEventElement(table, name);
+  return ShowerEleHolder.GetEventElement<shower::ShowerCalibratedHitTable>(name);
+}
+
 void shower::LArPandoraShowerAlg::DebugEVD(art::Ptr<recob::PFParticle> const& pfparticle,
                                            art::Event const& Event,
                                            reco::shower::ShowerElementHolder const& ShowerEleHolder,
@@ -5,11 +5,19 @@ namespace reco::shower {
   class ShowerElementHolder;
 }
 
+namespace calo {
+  class CalorimetryAlg;
+}
+
 namespace detinfo {
   class DetectorClocksData;
   class DetectorPropertiesData;
 }
 
+namespace fhicl {
+  class ParameterSetID;
+}
+
 #include "larcore/Geometry/Geometry.h"
 
 namespace recob {
@@ -35,6 +43,8 @@ namespace spacecharge {
 
 namespace shower {
   class LArPandoraShowerAlg;
+  class ShowerCalibratedHitTable;
+  class ShowerSpacePointGrid;
 }
 
 class shower::LArPandoraShowerAlg {
@@ -95,6 +105,25 @@ public:
                                  geo::Vector_t const& direction,
                                  double proj) const;
 
+  // Get the spacepoint grid of a PFParticle, built once per event and kept in the element holder
+  const shower::ShowerSpacePointGrid& GetSpacePointGrid(
+    art::Ptr<recob::PFParticle> const& pfparticle,
+    art::Event const& Event,
+    art::InputTag const& pfParticleLabel,
+    reco::shower::ShowerElementHolder& ShowerEleHolder) const;
+
+  // Get the calibrated charge of the hits of the PFParticle clusters, built once per event and
+  // kept in the element holder. The table is shared by the tools whose CalorimetryAlg has the
+  // same configuration, given by the ID of its parameter set
+  const shower::ShowerCalibratedHitTable& GetCalibratedHitTable(
+    art::Event const& Event,
+    art::InputTag const& pfParticleLabel,
+    detinfo::DetectorClocksData const& clockData,
+    detinfo::DetectorPropertiesData const& detProp,
+    calo::CalorimetryAlg const& calorimetryAlg,
+    fhicl::ParameterSetID const& calorimetryAlgID,
+    reco::shower::ShowerElementHolder& ShowerEleHolder) const;
+
   double RMSShowerGradient(std::vector<art::Ptr<recob::SpacePoint>>& sps,
                            const geo::Point_t& ShowerCentre,
                            const geo::Vector_t& Direction,
@@ -122,6 +151,7 @@ private:
   bool fUseCollectionOnly;
   art::InputTag fPFParticleLabel;
   bool fSCEXFlip; // If a (legacy) flip is needed in x componant of spatial SCE correction
+  double fSpacePointGridCellSize; // Cell size of the spacepoint grids
 
   spacecharge::SpaceCharge const* fSCE;
   art::ServiceHandle<geo::Geometry const> fGeom;
@@ -0,0 +1,95 @@
+#include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Algs/ShowerCalibratedHitTable.h"
+
+#include "lardataalg/DetectorInfo/DetectorClocksData.h"
+#include "lardataalg/DetectorInfo/DetectorPropertiesData.h"
+#include "lardataobj/RecoBase/Hit.h"
+#include "larreco/Calorimetry/CalorimetryAlg.h"
+
+#include "cetlib_except/exception.h"
+
+#include <algorithm>
+#include <iterator>
+
+shower::ShowerCalibratedHitTable::ShowerCalibratedHitTable(
+  std::vector<art::Ptr<recob::Hit>> const& hits,
+  detinfo::DetectorClocksData const& clockData,
+  detinfo::DetectorPropertiesData const& detProp,
+  calo::CalorimetryAlg const& calorimetryAlg)
+  : fNumHits(0)
+{
+  //Find the largest key of each hit collection, to lay the collections out one after another
+  for (auto const& hit : hits) {
+    auto range = std::find_if(fRanges.begin(), fRanges.end(), [&hit](ProductRange const& r) {
+      return r.productID == hit.id();
+    });
+    if (range == fRanges.end()) {
+      fRanges.push_back({hit.id(), 0, 0});
+      range = std::prev(fRanges.end());
+    }
+    range->numKeys = std::max(range->numKeys, hit.key() + 1);
+  }
+
+  size_t numEntries = 0;
+  for (auto& range : fRanges) {
+    range.offset = numEntries;
+    numEntries += range.numKeys;
+  }
+
+  fFilled.assign(numEntries, false);
+  fLifetimeCorrections.assign(numEntries, 0);
+  fCorrectedCharges.assign(numEntries, 0);
+  fElectrons.assign(numEntries, 0);
+  fPlanes.assign(numEntries, 0);
+
+  //Gather each hit once, so hits shared between clusters are only corrected once
+  std::vector<size_t> indices;
+  std::vector<float> charges;
+  std::vector<float> peakTimes;
+  indices.reserve(hits.size());
+  charges.reserve(hits.size());
+  peakTimes.reserve(hits.size());
+  for (auto const& hit : hits) {
+    const size_t index = FindRange(hit.id())->offset + hit.key();
+    if (fFilled[index]) continue;
+    fFilled[index] = true;
+    fPlanes[index] = hit->WireID().Plane;
+    indices.push_back(index);
+    charges.push_back(hit->Integral());
+    peakTimes.push_back(hit->PeakTime());
+  }
+  fNumHits = indices.size();
+
+  //Then correct and convert the gathered charges in one pass
+  for (size_t i = 0; i < fNumHits; ++i) {
+    const double correction = calorimetryAlg.LifetimeCorrection(clockData, detProp, peakTimes[i]);
+    fLifetimeCorrections[indices[i]] = correction;
+    fCorrectedCharges[indices[i]] = charges[i] * correction;
+    fElectrons[indices[i]] =
+      calorimetryAlg.ElectronsFromADCArea(fCorrectedCharges[indices[i]], fPlanes[indices[i]]);
+  }
+}
+
+const shower::ShowerCalibratedHitTable::ProductRange* shower::ShowerCalibratedHitTable::FindRange(
+  art::ProductID const& productID) const
+{
+  for (auto const& range : fRanges) {
+    if (range.productID == productID) return &range;
+  }
+  return nullptr;
+}
+
+bool shower::ShowerCalibratedHitTable::HasHit(art::Ptr<recob::Hit> const& hit) const
+{
+  const ProductRange* range = FindRange(hit.id());
+  return range && hit.key() < range->numKeys && fFilled[range->offset + hit.key()];
+}
+
+size_t shower::ShowerCalibratedHitTable::Index(art::Ptr<recob::Hit> const& hit) const
+{
+  const ProductRange* range = FindRange(hit.id());
+  if (!range || hit.key() >= range->numKeys || !fFilled[range->offset + hit.key()]) {
+    throw cet::exception("ShowerCalibratedHitTable")
+      << "Hit " << hit.key() << " is not in the calibrated hit table" << std::endl;
+  }
+  return range->offset + hit.key();
+}
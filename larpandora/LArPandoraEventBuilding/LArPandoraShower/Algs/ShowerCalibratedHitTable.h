@@ -0,0 +1,89 @@
+#ifndef ShowerCalibratedHitTable_hxx
+#define ShowerCalibratedHitTable_hxx
+
+//LArSoft Includes
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+
+namespace calo {
+  class CalorimetryAlg;
+}
+
+namespace detinfo {
+  class DetectorClocksData;
+  class DetectorPropertiesData;
+}
+
+namespace recob {
+  class Hit;
+}
+
+#include "canvas/Persistency/Common/Ptr.h"
+#include "canvas/Persistency/Provenance/ProductID.h"
+
+//C++ Includes
+#include <vector>
+
+namespace shower {
+  class ShowerCalibratedHitTable;
+}
+
+//Per event table of the calibrated charge of a set of hits, e.g. those of the PFParticle
+//clusters, indexed by the hit collection and key. The lifetime correction (one exp per hit) and
+//the conversion to electrons are done once for the whole set, rather than for each shower and
+//tool using the hit. Both are those of the CalorimetryAlg the table is built with, for a T0 of
+//zero, so a table should only be shared between tools with the same CalorimetryAlg configuration.
+class shower::ShowerCalibratedHitTable {
+public:
+  ShowerCalibratedHitTable(std::vector<art::Ptr<recob::Hit>> const& hits,
+                           detinfo::DetectorClocksData const& clockData,
+                           detinfo::DetectorPropertiesData const& detProp,
+                           calo::CalorimetryAlg const& calorimetryAlg);
+
+  bool HasHit(art::Ptr<recob::Hit> const& hit) const;
+
+  //Charge (hit integral) multiplied by the lifetime correction
+  double LifetimeCorrectedCharge(art::Ptr<recob::Hit> const& hit) const
+  {
+    return fCorrectedCharges[Index(hit)];
+  }
+
+  double LifetimeCorrection(art::Ptr<recob::Hit> const& hit) const
+  {
+    return fLifetimeCorrections[Index(hit)];
+  }
+
+  //Number of electrons from the lifetime corrected charge, using the area calibration constants
+  double Electrons(art::Ptr<recob::Hit> const& hit) const { return fElectrons[Index(hit)]; }
+
+  geo::PlaneID::PlaneID_t Plane(art::Ptr<recob::Hit> const& hit) const
+  {
+    return fPlanes[Index(hit)];
+  }
+
+  size_t NumHits() const { return fNumHits; }
+
+private:
+  //The keys of each hit collection the table was built from, which take the entries from offset
+  //to offset + numKeys in the table. There is usually a single collection
+  struct ProductRange {
+    art::ProductID productID;
+    size_t offset;
+    size_t numKeys;
+  };
+
+  //Get the range of the hit collection, or nullptr if no hits are from the collection
+  const ProductRange* FindRange(art::ProductID const& productID) const;
+
+  //Get the index of a hit in the table, throws if the hit is not in the table
+  size_t Index(art::Ptr<recob::Hit> const& hit) const;
+
+  std::vector<ProductRange> fRanges;
+  size_t fNumHits;
+  std::vector<bool> fFilled; //Whether each entry is in the table
+  std::vector<double> fLifetimeCorrections;
+  std::vector<double> fCorrectedCharges;
+  std::vector<double> fElectrons;
+  std::vector<geo::PlaneID::PlaneID_t> fPlanes;
+};
+
+#endif
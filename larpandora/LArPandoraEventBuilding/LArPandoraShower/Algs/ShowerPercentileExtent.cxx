@@ -0,0 +1,55 @@
+#include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Algs/ShowerPercentileExtent.h"
+
+#include "cetlib_except/exception.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+shower::ShowerPercentileExtent::ShowerPercentileExtent(std::vector<double> const& projections,
+                                                       std::vector<double> const& perpendiculars,
+                                                       float percentile)
+{
+  if (projections.empty() || projections.size() != perpendiculars.size()) {
+    throw cet::exception("ShowerPercentileExtent")
+      << "Need a projection and a perpendicular for each spacepoint, got " << projections.size()
+      << " and " << perpendiculars.size() << std::endl;
+  }
+
+  //Spacepoints with the same projection count once, and the last of them is the one that counts
+  std::unordered_map<double, size_t> projectionToSpacePoint;
+  projectionToSpacePoint.reserve(projections.size());
+  for (size_t i = 0; i < projections.size(); ++i) {
+    projectionToSpacePoint[projections[i]] = i;
+  }
+
+  //Get the distinct projections and the perpendicular distances of the spacepoints that count.
+  //Take the projection of the spacepoint that counts rather than the key, so that -0 and +0 are
+  //the same as for the map ordering
+  std::vector<double> distinctProjections;
+  distinctProjections.reserve(projectionToSpacePoint.size());
+  std::vector<double> distinctPerpendiculars;
+  distinctPerpendiculars.reserve(projectionToSpacePoint.size());
+  std::unordered_set<double> perpendicularSet;
+  perpendicularSet.reserve(projectionToSpacePoint.size());
+  for (auto const& [projection, index] : projectionToSpacePoint) {
+    distinctProjections.push_back(projections[index]);
+    if (perpendicularSet.insert(perpendiculars[index]).second)
+      distinctPerpendiculars.push_back(perpendiculars[index]);
+  }
+
+  //Find the length as the value that contains % of the hits
+  int lengthIter = percentile * distinctProjections.size();
+  std::nth_element(distinctProjections.begin(),
+                   distinctProjections.begin() + lengthIter,
+                   distinctProjections.end());
+  fLength = distinctProjections[lengthIter];
+  fMaxProjection = *std::max_element(distinctProjections.begin(), distinctProjections.end());
+
+  //Find the width as the value that contains % of the hits
+  int perpIter = percentile * distinctPerpendiculars.size();
+  std::nth_element(distinctPerpendiculars.begin(),
+                   distinctPerpendiculars.begin() + perpIter,
+                   distinctPerpendiculars.end());
+  fWidth = distinctPerpendiculars[perpIter];
+}
@@ -0,0 +1,36 @@
+#ifndef ShowerPercentileExtent_hxx
+#define ShowerPercentileExtent_hxx
+
+//C++ Includes
+#include <vector>
+
+namespace shower {
+  class ShowerPercentileExtent;
+}
+
+//The length and width within which a percentile of the shower spacepoints lie, from the
+//projection and perpendicular distance of each spacepoint along the shower direction. As when
+//ordering the spacepoints in a map with OrderShowerSpacePoints and then
+//OrderShowerSpacePointsPerpendicular, spacepoints with an equal projection count once, the last
+//one in the input ordering being kept, and equal perpendicular distances then count once. Only
+//the percentile values are selected rather than a full ordering, and the results are bit
+//identical to those of the map orderings.
+class shower::ShowerPercentileExtent {
+public:
+  //The projections and perpendiculars are per spacepoint, in the input ordering. Throws if they
+  //are empty or of different sizes
+  ShowerPercentileExtent(std::vector<double> const& projections,
+                         std::vector<double> const& perpendiculars,
+                         float percentile);
+
+  double Length() const { return fLength; }               //Projection at the percentile
+  double MaxProjection() const { return fMaxProjection; } //Largest projection
+  double Width() const { return fWidth; }                 //Perpendicular at the percentile
+
+private:
+  double fLength;
+  double fMaxProjection;
+  double fWidth;
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Algs/ShowerPlaneGeometryTable.h"
+
+#include "larcorealg/Geometry/GeometryCore.h"
+
+#include "cetlib_except/exception.h"
+
+#include "TMath.h"
+
+#include <cmath>
+
+shower::ShowerPlaneGeometryTable::ShowerPlaneGeometryTable(geo::GeometryCore const& geom)
+  : fMaxPlanes(geom.MaxPlanes())
+{
+  fCryostatOffsets.assign(1, 0);
+  for (unsigned int cryo = 0; cryo < geom.Ncryostats(); ++cryo) {
+    fCryostatOffsets.push_back(fCryostatOffsets.back() + geom.NTPC(geo::CryostatID(cryo)));
+  }
+
+  fHasPlane.assign(fCryostatOffsets.back() * fMaxPlanes, false);
+  fPlanes.resize(fCryostatOffsets.back() * fMaxPlanes);
+
+  for (auto const& plane : geom.Iterate<geo::PlaneGeo>()) {
+    const geo::PlaneID planeID = plane.ID();
+    const size_t index = TPCIndex(planeID.asTPCID()) + planeID.Plane;
+
+    PlaneGeometry& planeGeometry = fPlanes[index];
+    planeGeometry.view = plane.View();
+    planeGeometry.wirePitch = geom.WirePitch(planeID);
+    planeGeometry.wireAngleToVertical = geom.WireAngleToVertical(plane.View(), planeID);
+    const double angleToVert = planeGeometry.wireAngleToVertical - 0.5 * TMath::Pi();
+    planeGeometry.sinWireAngle = std::sin(angleToVert);
+    planeGeometry.cosWireAngle = std::cos(angleToVert);
+    planeGeometry.wireDirection = plane.GetIncreasingWireDirection();
+    fHasPlane[index] = true;
+  }
+}
+
+shower::ShowerPlaneGeometryTable::PlaneGeometry const&
+shower::ShowerPlaneGeometryTable::GetPlane(geo::PlaneID const& planeID) const
+{
+  const size_t tpcIndex = TPCIndex(planeID.asTPCID());
+  if (tpcIndex == fPlanes.size() || planeID.Plane >= fMaxPlanes ||
+      !fHasPlane[tpcIndex + planeID.Plane]) {
+    throw cet::exception("ShowerPlaneGeometryTable")
+      << "No plane " << planeID.toString() << " in the geometry" << std::endl;
+  }
+  return fPlanes[tpcIndex + planeID.Plane];
+}
+
+shower::ShowerPlaneGeometryTable::PlaneGeometry const&
+shower::ShowerPlaneGeometryTable::FindPlane(geo::TPCID const& tpcID, geo::View_t view) const
+{
+  const size_t tpcIndex = TPCIndex(tpcID);
+  if (tpcIndex != fPlanes.size()) {
+    for (unsigned int plane = 0; plane < fMaxPlanes; ++plane) {
+      if (fHasPlane[tpcIndex + plane] && fPlanes[tpcIndex + plane].view == view)
+        return fPlanes[tpcIndex + plane];
+    }
+  }
+  throw cet::exception("ShowerPlaneGeometryTable")
+    << "No plane with view " << view << " in " << tpcID.toString() << std::endl;
+}
+
+size_t shower::ShowerPlaneGeometryTable::TPCIndex(geo::TPCID const& tpcID) const
+{
+  if (!tpcID.isValid || tpcID.Cryostat + 1 >= fCryostatOffsets.size()) return fPlanes.size();
+
+  const size_t tpc = fCryostatOffsets[tpcID.Cryostat] + tpcID.TPC;
+  if (tpc >= fCryostatOffsets[tpcID.Cryostat + 1]) return fPlanes.size();
+
+  return tpc * fMaxPlanes;
+}
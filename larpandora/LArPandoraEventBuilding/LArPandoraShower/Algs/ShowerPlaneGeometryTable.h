@@ -0,0 +1,53 @@
+#ifndef ShowerPlaneGeometryTable_hxx
+#define ShowerPlaneGeometryTable_hxx
+
+//LArSoft Includes
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_vectors.h"
+
+namespace geo {
+  class GeometryCore;
+}
+
+//C++ Includes
+#include <vector>
+
+namespace shower {
+  class ShowerPlaneGeometryTable;
+}
+
+//Table of the wire plane quantities used by the dEdx tools, for every (TPC, plane) pair, so that
+//the pitch can be calculated without querying the geometry for each shower and hit. The values
+//are those of the geometry service at construction, so the table should be rebuilt if the run
+//changes.
+class shower::ShowerPlaneGeometryTable {
+public:
+  struct PlaneGeometry {
+    geo::View_t view;
+    double wirePitch;
+    double wireAngleToVertical; //As GeometryCore::WireAngleToVertical for the plane view
+    double sinWireAngle;        //sin(wireAngleToVertical - pi/2)
+    double cosWireAngle;        //cos(wireAngleToVertical - pi/2)
+    geo::Vector_t wireDirection; //Direction of increasing wire number
+  };
+
+  ShowerPlaneGeometryTable(geo::GeometryCore const& geom);
+
+  //Get the geometry of a plane, throws if the plane does not exist
+  PlaneGeometry const& GetPlane(geo::PlaneID const& planeID) const;
+
+  //Get the geometry of the first plane in the TPC with the view, as
+  //GeometryCore::WireAngleToVertical. Throws if there is no such plane
+  PlaneGeometry const& FindPlane(geo::TPCID const& tpcID, geo::View_t view) const;
+
+private:
+  //Get the index of the first plane of a TPC in fPlanes, or fPlanes.size() if there is no TPC
+  size_t TPCIndex(geo::TPCID const& tpcID) const;
+
+  unsigned int fMaxPlanes;
+  std::vector<size_t> fCryostatOffsets; //Index of the first TPC of each cryostat, then the size
+  std::vector<bool> fHasPlane;           //Whether each (TPC, plane) pair exists
+  std::vector<PlaneGeometry> fPlanes;    //The planes, fMaxPlanes per TPC
+};
+
+#endif
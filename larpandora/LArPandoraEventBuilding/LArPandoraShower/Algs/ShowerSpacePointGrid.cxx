@@ -0,0 +1,244 @@
+#include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Algs/ShowerSpacePointGrid.h"
+
+#include "lardataobj/RecoBase/SpacePoint.h"
+
+#include "cetlib_except/exception.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+shower::ShowerSpacePointGrid::ShowerSpacePointGrid(
+  std::vector<art::Ptr<recob::SpacePoint>> const& spacePoints,
+  double cellSize)
+  : fSpacePoints(spacePoints)
+  , fGridMin(0, 0, 0)
+  , fCellSize(cellSize)
+  , fNumCellsX(1)
+  , fNumCellsY(1)
+  , fNumCellsZ(1)
+{
+  if (!(cellSize > 0)) {
+    throw cet::exception("ShowerSpacePointGrid")
+      << "The cell size must be positive: " << cellSize << std::endl;
+  }
+
+  if (fSpacePoints.empty()) {
+    fCellOffsets.assign(2, 0);
+    return;
+  }
+
+  //Get the bounding box of the spacepoints
+  geo::Point_t gridMax = fSpacePoints.front()->position();
+  fGridMin = gridMax;
+  for (auto const& sp : fSpacePoints) {
+    auto const pos = sp->position();
+    fGridMin.SetXYZ(std::min(fGridMin.X(), pos.X()),
+                    std::min(fGridMin.Y(), pos.Y()),
+                    std::min(fGridMin.Z(), pos.Z()));
+    gridMax.SetXYZ(std::max(gridMax.X(), pos.X()),
+                   std::max(gridMax.Y(), pos.Y()),
+                   std::max(gridMax.Z(), pos.Z()));
+  }
+
+  //Enlarge the cells if needed so that there are not many more cells than spacepoints
+  const double maxNumCells = 8. * fSpacePoints.size();
+  auto const extent = gridMax - fGridMin;
+  while (true) {
+    const double numCells = (std::floor(extent.X() / fCellSize) + 1) *
+                            (std::floor(extent.Y() / fCellSize) + 1) *
+                            (std::floor(extent.Z() / fCellSize) + 1);
+    if (numCells <= maxNumCells) break;
+    fCellSize *= std::max(1.1, std::cbrt(numCells / maxNumCells));
+  }
+
+  fNumCellsX = std::floor(extent.X() / fCellSize) + 1;
+  fNumCellsY = std::floor(extent.Y() / fCellSize) + 1;
+  fNumCellsZ = std::floor(extent.Z() / fCellSize) + 1;
+
+  //Bin the spacepoints with a counting sort, so that each cell is contiguous
+  std::vector<size_t> spacePointCells;
+  spacePointCells.reserve(fSpacePoints.size());
+  fCellOffsets.assign(static_cast<size_t>(fNumCellsX) * fNumCellsY * fNumCellsZ + 1, 0);
+  for (auto const& sp : fSpacePoints) {
+    auto const pos = sp->position() - fGridMin;
+    const int ix = std::min(static_cast<int>(pos.X() / fCellSize), fNumCellsX - 1);
+    const int iy = std::min(static_cast<int>(pos.Y() / fCellSize), fNumCellsY - 1);
+    const int iz = std::min(static_cast<int>(pos.Z() / fCellSize), fNumCellsZ - 1);
+    spacePointCells.push_back((static_cast<size_t>(ix) * fNumCellsY + iy) * fNumCellsZ + iz);
+    ++fCellOffsets[spacePointCells.back() + 1];
+  }
+
+  for (size_t cell = 1; cell < fCellOffsets.size(); ++cell) {
+    fCellOffsets[cell] += fCellOffsets[cell - 1];
+  }
+
+  fCellSpacePoints.resize(fSpacePoints.size());
+  std::vector<size_t> cellFill(fCellOffsets.begin(), fCellOffsets.end() - 1);
+  for (size_t i = 0; i < fSpacePoints.size(); ++i) {
+    fCellSpacePoints[cellFill[spacePointCells[i]]++] = i;
+  }
+}
+
+template <typename F>
+void shower::ShowerSpacePointGrid::ForEachCandidate(geo::Point_t const& boxMin,
+                                                    geo::Point_t const& boxMax,
+                                                    F&& func) const
+{
+  if (fSpacePoints.empty()) return;
+
+  //Get the range of cells overlapping the box along one axis, false if there are none
+  auto const cellRange =
+    [this](double low, double high, double gridMin, int numCells, int& first, int& last) {
+      const double firstCell = std::floor((low - gridMin) / fCellSize);
+      const double lastCell = std::floor((high - gridMin) / fCellSize);
+      if (lastCell < 0 || firstCell > numCells - 1) return false;
+      first = std::max(firstCell, 0.);
+      last = std::min(lastCell, numCells - 1.);
+      return true;
+    };
+
+  int ix0, ix1, iy0, iy1, iz0, iz1;
+  if (!cellRange(boxMin.X(), boxMax.X(), fGridMin.X(), fNumCellsX, ix0, ix1) ||
+      !cellRange(boxMin.Y(), boxMax.Y(), fGridMin.Y(), fNumCellsY, iy0, iy1) ||
+      !cellRange(boxMin.Z(), boxMax.Z(), fGridMin.Z(), fNumCellsZ, iz0, iz1))
+    return;
+
+  for (int ix = ix0; ix <= ix1; ++ix) {
+    for (int iy = iy0; iy <= iy1; ++iy) {
+      //Cells along z are contiguous, as are their spacepoints
+      const size_t firstCell = (static_cast<size_t>(ix) * fNumCellsY + iy) * fNumCellsZ;
+      for (size_t j = fCellOffsets[firstCell + iz0]; j < fCellOffsets[firstCell + iz1 + 1]; ++j) {
+        func(fCellSpacePoints[j]);
+      }
+    }
+  }
+}
+
+std::vector<art::Ptr<recob::SpacePoint>> shower::ShowerSpacePointGrid::CylinderQuery(
+  geo::Point_t const& start,
+  geo::Vector_t const& direction,
+  double maxProjection,
+  double radius,
+  bool forwardOnly) const
+{
+  auto const box =
+    AxisBox(start, direction, forwardOnly ? 0 : -maxProjection, maxProjection, radius);
+
+  std::vector<std::pair<double, size_t>> selected;
+  ForEachCandidate(box.first, box.second, [&](size_t i) {
+    auto const pos = fSpacePoints[i]->position() - start;
+    const double proj = pos.Dot(direction);
+    const double perp = (pos - proj * direction).R();
+
+    if (forwardOnly && proj < 0) return;
+
+    if (std::abs(proj) < maxProjection && std::abs(perp) < radius) selected.emplace_back(proj, i);
+  });
+
+  OrderSelected(selected);
+  if (selected.empty()) return {};
+
+  //A later spacepoint with an equal projection replaces a selected one, as in the ordering of all
+  //of the spacepoints by OrderShowerSpacePoints, so that neither is kept if it is outside
+  std::vector<bool> replaced(selected.size(), false);
+  for (size_t i = 0; i < fSpacePoints.size(); ++i) {
+    const double proj = (fSpacePoints[i]->position() - start).Dot(direction);
+    if (proj < selected.front().first || proj > selected.back().first) continue;
+
+    auto const next = std::upper_bound(
+      selected.begin(),
+      selected.end(),
+      proj,
+      [](double key, std::pair<double, size_t> const& entry) { return key < entry.first; });
+    if (next == selected.begin()) continue;
+
+    auto const equal = std::prev(next);
+    if (equal->first == proj && equal->second < i) replaced[equal - selected.begin()] = true;
+  }
+
+  size_t nKept = 0;
+  for (size_t i = 0; i < selected.size(); ++i) {
+    if (!replaced[i]) selected[nKept++] = selected[i];
+  }
+  selected.resize(nKept);
+
+  return GetSelected(selected);
+}
+
+std::vector<art::Ptr<recob::SpacePoint>> shower::ShowerSpacePointGrid::SphereQuery(
+  geo::Point_t const& centre,
+  double radius) const
+{
+  //Pad the box to cover the rounding of the distances to the centre
+  const double pad = radius + 1e-5 * std::abs(radius);
+  const geo::Vector_t halfDiagonal(pad, pad, pad);
+
+  std::vector<std::pair<double, size_t>> selected;
+  ForEachCandidate(centre - halfDiagonal, centre + halfDiagonal, [&](size_t i) {
+    const double dist = (fSpacePoints[i]->position() - centre).R();
+
+    if (dist <= radius) selected.emplace_back(dist, i);
+  });
+
+  //Spacepoints with an equal distance are all selected, so none outside replaces a selected one
+  OrderSelected(selected);
+  return GetSelected(selected);
+}
+
+std::pair<geo::Point_t, geo::Point_t> shower::ShowerSpacePointGrid::AxisBox(
+  geo::Point_t const& start,
+  geo::Vector_t const& direction,
+  double minProjection,
+  double maxProjection,
+  double radius) const
+{
+  //The padding only covers the rounding for a unit direction, otherwise visit every cell
+  if (std::abs(direction.Mag2() - 1) > 1e-6) {
+    const double max = std::numeric_limits<double>::max();
+    return {geo::Point_t(-max, -max, -max), geo::Point_t(max, max, max)};
+  }
+
+  //Pad the box to cover the rounding of a direction normalised to within the tolerance
+  const double pad =
+    radius + 1e-5 * (std::abs(minProjection) + std::abs(maxProjection) + std::abs(radius));
+  auto const low = start + minProjection * direction;
+  auto const high = start + maxProjection * direction;
+  return {geo::Point_t(std::min(low.X(), high.X()) - pad,
+                       std::min(low.Y(), high.Y()) - pad,
+                       std::min(low.Z(), high.Z()) - pad),
+          geo::Point_t(std::max(low.X(), high.X()) + pad,
+                       std::max(low.Y(), high.Y()) + pad,
+                       std::max(low.Z(), high.Z()) + pad)};
+}
+
+void shower::ShowerSpacePointGrid::OrderSelected(
+  std::vector<std::pair<double, size_t>>& keysAndIndices) const
+{
+  std::sort(keysAndIndices.begin(),
+            keysAndIndices.end(),
+            [](std::pair<double, size_t> const& lhs, std::pair<double, size_t> const& rhs) {
+              if (lhs.first != rhs.first) return lhs.first < rhs.first;
+              return lhs.second < rhs.second;
+            });
+
+  size_t nKept = 0;
+  for (size_t i = 0; i < keysAndIndices.size(); ++i) {
+    if (i + 1 < keysAndIndices.size() && keysAndIndices[i + 1].first == keysAndIndices[i].first)
+      continue;
+    keysAndIndices[nKept++] = keysAndIndices[i];
+  }
+  keysAndIndices.resize(nKept);
+}
+
+std::vector<art::Ptr<recob::SpacePoint>> shower::ShowerSpacePointGrid::GetSelected(
+  std::vector<std::pair<double, size_t>> const& keysAndIndices) const
+{
+  std::vector<art::Ptr<recob::SpacePoint>> ordered;
+  ordered.reserve(keysAndIndices.size());
+  for (auto const& keyAndIndex : keysAndIndices) {
+    ordered.push_back(fSpacePoints[keyAndIndex.second]);
+  }
+  return ordered;
+}
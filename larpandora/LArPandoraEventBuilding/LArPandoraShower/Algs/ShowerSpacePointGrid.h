@@ -0,0 +1,74 @@
+#ifndef ShowerSpacePointGrid_hxx
+#define ShowerSpacePointGrid_hxx
+
+//LArSoft Includes
+#include "larcoreobj/SimpleTypesAndConstants/geo_vectors.h"
+
+namespace recob {
+  class SpacePoint;
+}
+
+#include "canvas/Persistency/Common/Ptr.h"
+
+//C++ Includes
+#include <utility>
+#include <vector>
+
+namespace shower {
+  class ShowerSpacePointGrid;
+}
+
+//Voxel grid over a set of spacepoints, e.g. those of a PFParticle, for geometric selections
+//around the shower start and direction. Only the cells overlapping a query are visited, and
+//only the selected spacepoints are ordered. As OrderShowerSpacePoints, the results are ordered
+//by projection (or distance) and spacepoints with an equal value count once, the last one in
+//the input ordering being kept, even if it is outside the selection.
+class shower::ShowerSpacePointGrid {
+public:
+  ShowerSpacePointGrid(std::vector<art::Ptr<recob::SpacePoint>> const& spacePoints,
+                       double cellSize);
+
+  //Spacepoints with |projection| < maxProjection along the direction from the start and
+  //perpendicular distance < radius, with projection >= 0 if forwardOnly. Ordered by projection.
+  std::vector<art::Ptr<recob::SpacePoint>> CylinderQuery(geo::Point_t const& start,
+                                                         geo::Vector_t const& direction,
+                                                         double maxProjection,
+                                                         double radius,
+                                                         bool forwardOnly) const;
+
+  //Spacepoints with distance <= radius from the centre. Ordered by distance.
+  std::vector<art::Ptr<recob::SpacePoint>> SphereQuery(geo::Point_t const& centre,
+                                                       double radius) const;
+
+  size_t NumSpacePoints() const { return fSpacePoints.size(); }
+
+private:
+  //Call the function on the index of each spacepoint in the cells overlapping the box
+  template <typename F>
+  void ForEachCandidate(geo::Point_t const& boxMin, geo::Point_t const& boxMax, F&& func) const;
+
+  //Get the bounding box of a segment of the axis, widened by a radius
+  std::pair<geo::Point_t, geo::Point_t> AxisBox(geo::Point_t const& start,
+                                                geo::Vector_t const& direction,
+                                                double minProjection,
+                                                double maxProjection,
+                                                double radius) const;
+
+  //Order the selected spacepoints by key, keeping the last of each equal key
+  void OrderSelected(std::vector<std::pair<double, size_t>>& keysAndIndices) const;
+
+  //Get the spacepoints of the ordered selection
+  std::vector<art::Ptr<recob::SpacePoint>> GetSelected(
+    std::vector<std::pair<double, size_t>> const& keysAndIndices) const;
+
+  std::vector<art::Ptr<recob::SpacePoint>> fSpacePoints; //The spacepoints, in the input ordering
+  std::vector<size_t> fCellOffsets; //Offset of each cell in fCellSpacePoints, then its size
+  std::vector<size_t> fCellSpacePoints; //The spacepoint indices, contiguous for each cell
+  geo::Point_t fGridMin;                //The low corner of the grid
+  double fCellSize;                     //The cell size, possibly enlarged to cap the cell count
+  int fNumCellsX;
+  int fNumCellsY;
+  int fNumCellsZ;
+};
+
+#endif
@@ -0,0 +1,81 @@
+#include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Algs/ShowerTrajSpacePointMatcher.h"
+
+#include <algorithm>
+#include <bit>
+
+shower::ShowerTrajSpacePointMatcher::ShowerTrajSpacePointMatcher(
+  std::vector<geo::Point_t> const& spacePoints,
+  float maxDist)
+  : fSpacePoints(spacePoints)
+  , fMaxDist(maxDist)
+  , fWindow(maxDist * 1.0001)
+  , fAxis(0)
+  , fUnmatched((spacePoints.size() + 63) / 64, ~std::uint64_t(0))
+  , fInWindow(fUnmatched.size(), 0)
+{
+  if (fSpacePoints.empty()) return;
+
+  //Sort along the axis of the largest spread, so that the windows hold the fewest spacepoints
+  geo::Point_t low = fSpacePoints.front(), high = fSpacePoints.front();
+  for (auto const& pos : fSpacePoints) {
+    low.SetXYZ(std::min(low.X(), pos.X()), std::min(low.Y(), pos.Y()), std::min(low.Z(), pos.Z()));
+    high.SetXYZ(
+      std::max(high.X(), pos.X()), std::max(high.Y(), pos.Y()), std::max(high.Z(), pos.Z()));
+  }
+
+  auto const spread = high - low;
+  if (spread.Y() > spread.X() && spread.Y() >= spread.Z())
+    fAxis = 1;
+  else if (spread.Z() > spread.X() && spread.Z() > spread.Y())
+    fAxis = 2;
+
+  fSortedSpacePoints.reserve(fSpacePoints.size());
+  for (size_t sp = 0; sp < fSpacePoints.size(); ++sp) {
+    fSortedSpacePoints.emplace_back(AxisCoordinate(fSpacePoints[sp]), sp);
+  }
+  std::sort(fSortedSpacePoints.begin(), fSortedSpacePoints.end());
+}
+
+size_t shower::ShowerTrajSpacePointMatcher::Match(geo::Point_t const& position)
+{
+  //Flag the spacepoints in the window along the axis
+  const double coordinate = AxisCoordinate(position);
+  size_t firstWord = fInWindow.size(), lastWord = 0;
+  for (auto iter = std::lower_bound(fSortedSpacePoints.begin(),
+                                    fSortedSpacePoints.end(),
+                                    std::make_pair(coordinate - fWindow, size_t(0)));
+       iter != fSortedSpacePoints.end() && iter->first <= coordinate + fWindow;
+       ++iter) {
+    const size_t word = iter->second / 64;
+    fInWindow[word] |= std::uint64_t(1) << (iter->second % 64);
+    firstWord = std::min(firstWord, word);
+    lastWord = std::max(lastWord, word);
+  }
+
+  //Visit the unmatched spacepoints in the window in the input ordering, as the first spacepoint
+  //found wins a tie, and clear the window as it is read
+  float minDist = 9999;
+  size_t index = NumSpacePoints();
+  for (size_t word = firstWord; word <= lastWord && word < fInWindow.size(); ++word) {
+    std::uint64_t bits = fInWindow[word] & fUnmatched[word];
+    fInWindow[word] = 0;
+
+    for (; bits; bits &= bits - 1) {
+      const size_t sp = word * 64 + std::countr_zero(bits);
+      auto const dist = (fSpacePoints[sp] - position).R();
+      if (dist < minDist && dist < fMaxDist) {
+        minDist = dist;
+        index = sp;
+      }
+    }
+  }
+
+  if (index != NumSpacePoints()) fUnmatched[index / 64] &= ~(std::uint64_t(1) << (index % 64));
+
+  return index;
+}
+
+double shower::ShowerTrajSpacePointMatcher::AxisCoordinate(geo::Point_t const& position) const
+{
+  return fAxis == 0 ? position.X() : (fAxis == 1 ? position.Y() : position.Z());
+}
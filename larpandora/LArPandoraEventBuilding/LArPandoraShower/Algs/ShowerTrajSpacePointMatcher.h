@@ -0,0 +1,44 @@
+#ifndef ShowerTrajSpacePointMatcher_hxx
+#define ShowerTrajSpacePointMatcher_hxx
+
+//LArSoft Includes
+#include "larcoreobj/SimpleTypesAndConstants/geo_vectors.h"
+
+//C++ Includes
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace shower {
+  class ShowerTrajSpacePointMatcher;
+}
+
+//Matches positions, e.g. the trajectory points of a track, each to the closest spacepoint within
+//a maximum distance that has not been matched before. As when checking every unmatched
+//spacepoint in the input ordering, the first of equally close spacepoints is matched. The
+//spacepoints are sorted along the axis of their largest spread, so only those within the maximum
+//distance along it are checked, and they are visited in the input ordering through a bitmap.
+class shower::ShowerTrajSpacePointMatcher {
+public:
+  ShowerTrajSpacePointMatcher(std::vector<geo::Point_t> const& spacePoints, float maxDist);
+
+  //Get the index of the closest unmatched spacepoint within the maximum distance of the position
+  //and flag it as matched, or NumSpacePoints() if there is none
+  size_t Match(geo::Point_t const& position);
+
+  size_t NumSpacePoints() const { return fSpacePoints.size(); }
+
+private:
+  //Get the coordinate of a position along the sorting axis
+  double AxisCoordinate(geo::Point_t const& position) const;
+
+  std::vector<geo::Point_t> fSpacePoints; //The spacepoints, in the input ordering
+  float fMaxDist;                         //The maximum distance of a match
+  double fWindow;     //Half width of the window along the axis, padded against rounding
+  int fAxis;          //The sorting axis, 0, 1 or 2 for x, y or z
+  std::vector<std::pair<double, size_t>> fSortedSpacePoints; //Coordinate along the axis and index
+  std::vector<std::uint64_t> fUnmatched; //Bitmap of the unmatched spacepoints
+  std::vector<std::uint64_t> fInWindow;  //Bitmap of the spacepoints in the current window
+};
+
+#endif
@@ -15,6 +15,7 @@
 #include "lardataobj/RecoBase/PFParticle.h"
 #include "lardataobj/RecoBase/SpacePoint.h"
 #include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Algs/LArPandoraShowerAlg.h"
+#include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Algs/ShowerSpacePointGrid.h"
 #include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Tools/IShowerTool.h"
 
 namespace ShowerRecoTools {
@@ -29,11 +30,6 @@ namespace ShowerRecoTools {
                          reco::shower::ShowerElementHolder& ShowerEleHolder) override;
 
   private:
-    std::vector<art::Ptr<recob::SpacePoint>> FindTrackSpacePoints(
-      std::vector<art::Ptr<recob::SpacePoint>>& spacePoints,
-      geo::Point_t const& showerStartPosition,
-      geo::Vector_t const& showerDirection) const;
-
     //Fcl paramters
     float fMaxProjectionDist;    //Maximum projection along shower direction.
     float fMaxPerpendicularDist; //Maximum perpendicular distance, radius of cylinder
@@ -89,13 +85,6 @@ namespace ShowerRecoTools {
     geo::Vector_t ShowerDirection = {-999, -999, -999};
     ShowerEleHolder.GetElement(fShowerDirectionInputLabel, ShowerDirection);
 
-    // Get the assocated pfParicle Handle
-    auto const pfpHandle = Event.getValidHandle<std::vector<recob::PFParticle>>(fPFParticleLabel);
-
-    // Get the spacepoint - PFParticle assn
-    const art::FindManyP<recob::SpacePoint>& fmspp =
-      ShowerEleHolder.GetFindManyP<recob::SpacePoint>(pfpHandle, Event, fPFParticleLabel);
-
     // Get the spacepoints
     auto const spHandle = Event.getValidHandle<std::vector<recob::SpacePoint>>(fPFParticleLabel);
 
@@ -103,23 +92,25 @@ namespace ShowerRecoTools {
     const art::FindManyP<recob::Hit>& fmhsp =
       ShowerEleHolder.GetFindManyP<recob::Hit>(spHandle, Event, fPFParticleLabel);
 
-    // Get the SpacePoints
-    std::vector<art::Ptr<recob::SpacePoint>> spacePoints = fmspp.at(pfparticle.key());
+    // Get the grid of the SpacePoints
+    const shower::ShowerSpacePointGrid& spacePointGrid =
+      IShowerTool::GetLArPandoraShowerAlg().GetSpacePointGrid(
+        pfparticle, Event, fPFParticleLabel, ShowerEleHolder);
 
     //We cannot progress with no spacepoints.
-    if (spacePoints.empty()) {
+    if (!spacePointGrid.NumSpacePoints()) {
       if (fVerbose)
         mf::LogError("Shower3DCylinderTrackHitFinder")
           << "No space points, returning " << std::endl;
       return 1;
     }
 
-    // Order the spacepoints
-    IShowerTool::GetLArPandoraShowerAlg().OrderShowerSpacePoints(
-      spacePoints, ShowerStartPosition, ShowerDirection);
-
-    // Get only the space points from the track
-    auto trackSpacePoints = FindTrackSpacePoints(spacePoints, ShowerStartPosition, ShowerDirection);
+    // Get only the space points from the track, ordered along the shower direction
+    auto trackSpacePoints = spacePointGrid.CylinderQuery(ShowerStartPosition,
+                                                         ShowerDirection,
+                                                         fMaxProjectionDist,
+                                                         fMaxPerpendicularDist,
+                                                         fForwardHitsOnly);
 
     // Get the hits associated to the space points and seperate them by planes
     std::vector<art::Ptr<recob::Hit>> trackHits;
@@ -135,31 +126,6 @@ namespace ShowerRecoTools {
     return 0;
   }
 
-  std::vector<art::Ptr<recob::SpacePoint>> Shower3DCylinderTrackHitFinder::FindTrackSpacePoints(
-    std::vector<art::Ptr<recob::SpacePoint>>& spacePoints,
-    geo::Point_t const& showerStartPosition,
-    geo::Vector_t const& showerDirection) const
-  {
-
-    // Make a vector to hold the output space points
-    std::vector<art::Ptr<recob::SpacePoint>> trackSpacePoints;
-
-    for (const auto& spacePoint : spacePoints) {
-      // Calculate the projection along direction and perpendicular distance
-      // from "axis" of shower TODO: change alg to return a pair for efficiency
-      double proj = IShowerTool::GetLArPandoraShowerAlg().SpacePointProjection(
-        spacePoint, showerStartPosition, showerDirection);
-      double perp = IShowerTool::GetLArPandoraShowerAlg().SpacePointPerpendicular(
-        spacePoint, showerStartPosition, showerDirection, proj);
-
-      if (fForwardHitsOnly && proj < 0) continue;
-
-      if (std::abs(proj) < fMaxProjectionDist && std::abs(perp) < fMaxPerpendicularDist)
-        trackSpacePoints.push_back(spacePoint);
-    }
-    return trackSpacePoints;
-  }
-
 }
 
 DEFINE_ART_CLASS_TOOL(ShowerRecoTools::Shower3DCylinderTrackHitFinder)
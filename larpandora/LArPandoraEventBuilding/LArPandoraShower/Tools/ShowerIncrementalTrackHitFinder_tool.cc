@@ -16,6 +16,7 @@
 #include "lardataobj/RecoBase/Hit.h"
 #include "lardataobj/RecoBase/PFParticle.h"
 #include "lardataobj/RecoBase/SpacePoint.h"
+#include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Algs/ShowerSpacePointGrid.h"
 #include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Tools/IShowerTool.h"
 
 //Root Includes
@@ -248,9 +249,11 @@ namespace ShowerRecoTools {
       }
     }
     else {
-      //Order the spacepoint using the magnitude away from the vertex
-      IShowerTool::GetLArPandoraShowerAlg().OrderShowerSpacePoints(spacePoints,
-                                                                   ShowerStartPosition);
+      //Select the spacepoints within the distance cut, ordered by the magnitude away from the
+      //vertex, without ordering the rest of the shower
+      spacePoints = IShowerTool::GetLArPandoraShowerAlg()
+                      .GetSpacePointGrid(pfparticle, Event, fPFParticleLabel, ShowerEleHolder)
+                      .SphereQuery(ShowerStartPosition, fDistanceCut);
     }
 
     //Remove the first x spacepoints
@@ -12,6 +12,7 @@
 //LArSoft Includes
 #include "lardataobj/RecoBase/PFParticle.h"
 #include "lardataobj/RecoBase/SpacePoint.h"
+#include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Algs/ShowerPercentileExtent.h"
 #include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Tools/IShowerTool.h"
 
 namespace ShowerRecoTools {
@@ -71,7 +72,7 @@ namespace ShowerRecoTools {
       ShowerEleHolder.GetFindManyP<recob::SpacePoint>(pfpHandle, Event, fPFParticleLabel);
 
     // Get the SpacePoints
-    std::vector<art::Ptr<recob::SpacePoint>> spacePoints = fmspp.at(pfparticle.key());
+    const std::vector<art::Ptr<recob::SpacePoint>>& spacePoints = fmspp.at(pfparticle.key());
     if (spacePoints.empty()) {
       if (fVerbose)
         mf::LogError("ShowerLengthPercentile") << "No Spacepoints, returning" << std::endl;
@@ -87,33 +88,26 @@ namespace ShowerRecoTools {
     geo::Vector_t ShowerDirection = {-999, -999, -999};
     ShowerEleHolder.GetElement(fShowerDirectionInputLabel, ShowerDirection);
 
-    //Order the spacepoints
-    IShowerTool::GetLArPandoraShowerAlg().OrderShowerSpacePoints(
-      spacePoints, ShowerStartPosition, ShowerDirection);
-
-    //Find the length as the value that contains % of the hits
-    int lengthIter = fPercentile * spacePoints.size();
-
-    //Find the length
-    double ShowerLength = IShowerTool::GetLArPandoraShowerAlg().SpacePointProjection(
-      spacePoints[lengthIter], ShowerStartPosition, ShowerDirection);
-    double ShowerMaxProjection = IShowerTool::GetLArPandoraShowerAlg().SpacePointProjection(
-      spacePoints[spacePoints.size() - 1], ShowerStartPosition, ShowerDirection);
-
-    double ShowerLengthError = ShowerMaxProjection - ShowerLength;
-
-    //Order the spacepoints in perpendicular
-    IShowerTool::GetLArPandoraShowerAlg().OrderShowerSpacePointsPerpendicular(
-      spacePoints, ShowerStartPosition, ShowerDirection);
+    //Get the projection and perpendicular distance of each spacepoint once
+    std::vector<double> spacePointProjections;
+    spacePointProjections.reserve(spacePoints.size());
+    std::vector<double> spacePointPerpendiculars;
+    spacePointPerpendiculars.reserve(spacePoints.size());
+    for (auto const& spacePoint : spacePoints) {
+      spacePointProjections.push_back(IShowerTool::GetLArPandoraShowerAlg().SpacePointProjection(
+        spacePoint, ShowerStartPosition, ShowerDirection));
+      spacePointPerpendiculars.push_back(
+        IShowerTool::GetLArPandoraShowerAlg().SpacePointPerpendicular(
+          spacePoint, ShowerStartPosition, ShowerDirection, spacePointProjections.back()));
+    }
 
-    //Find the length as the value that contains % of the hits
-    int perpIter = fPercentile * spacePoints.size();
+    //Find the length and width that contain % of the hits
+    const shower::ShowerPercentileExtent extent(
+      spacePointProjections, spacePointPerpendiculars, fPercentile);
 
-    //Find the width of the shower
-    double ShowerWidth = IShowerTool::GetLArPandoraShowerAlg().SpacePointPerpendicular(
-      spacePoints[perpIter], ShowerStartPosition, ShowerDirection);
-    // double ShowerMaxWidth = IShowerTool::GetLArPandoraShowerAlg().SpacePointPerpendicular(
-    //     spacePoints[spacePoints.size() -1], ShowerStartPosition, ShowerDirection);
+    double ShowerLength = extent.Length();
+    double ShowerLengthError = extent.MaxProjection() - ShowerLength;
+    double ShowerWidth = extent.Width();
 
     double ShowerAngle = std::atan(ShowerWidth / ShowerLength);
     double ShowerAngleError = -999; //TODO: Do properly
@@ -154,9 +154,13 @@ namespace ShowerRecoTools {
 
     double totalCharge = 0, totalEnergy = 0;
 
+    //The lifetime correction here is from tick 0 rather than the trigger time, as in the
+    //ShowerEnergyAlg, so it does not use the calibrated hit table
+    const double samplingRate = sampling_rate(clockData);
+    const double lifetime = detProp.ElectronLifetime() * 1e3;
+
     for (auto const& hit : hits) {
-      totalCharge += (hit->Integral() * std::exp((sampling_rate(clockData) * hit->PeakTime()) /
-                                                 (detProp.ElectronLifetime() * 1e3)));
+      totalCharge += (hit->Integral() * std::exp((samplingRate * hit->PeakTime()) / lifetime));
     }
 
     totalEnergy = (totalCharge * fGradients.at(plane)) + fIntercepts.at(plane);
@@ -17,6 +17,7 @@
 #include "lardata/DetectorInfoServices/DetectorPropertiesService.h"
 #include "lardataobj/RecoBase/Cluster.h"
 #include "lardataobj/RecoBase/PFParticle.h"
+#include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Algs/ShowerCalibratedHitTable.h"
 #include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Tools/IShowerTool.h"
 #include "larreco/Calorimetry/CalorimetryAlg.h"
 
@@ -36,10 +37,8 @@ namespace ShowerRecoTools {
                          reco::shower::ShowerElementHolder& ShowerElementHolder) override;
 
   private:
-    double CalculateEnergy(const detinfo::DetectorClocksData& clockData,
-                           const detinfo::DetectorPropertiesData& detProp,
-                           const std::vector<art::Ptr<recob::Hit>>& hits,
-                           const geo::PlaneID::PlaneID_t plane) const;
+    double CalculateEnergy(const shower::ShowerCalibratedHitTable& calibratedHits,
+                           const std::vector<art::Ptr<recob::Hit>>& hits) const;
 
     art::InputTag fPFParticleLabel;
     int fVerbose;
@@ -50,6 +49,7 @@ namespace ShowerRecoTools {
     //Services
     art::ServiceHandle<geo::Geometry> fGeom;
     calo::CalorimetryAlg fCalorimetryAlg;
+    fhicl::ParameterSetID fCalorimetryAlgID;
 
     // Declare stuff
     double fRecombinationFactor;
@@ -62,6 +62,7 @@ namespace ShowerRecoTools {
     , fShowerEnergyOutputLabel(pset.get<std::string>("ShowerEnergyOutputLabel"))
     , fShowerBestPlaneOutputLabel(pset.get<std::string>("ShowerBestPlaneOutputLabel"))
     , fCalorimetryAlg(pset.get<fhicl::ParameterSet>("CalorimetryAlg"))
+    , fCalorimetryAlgID(pset.get<fhicl::ParameterSet>("CalorimetryAlg").id())
     , fRecombinationFactor(pset.get<double>("RecombinationFactor"))
   {}
 
@@ -118,12 +119,22 @@ namespace ShowerRecoTools {
     auto const detProp =
       art::ServiceHandle<detinfo::DetectorPropertiesService const>()->DataFor(Event, clockData);
 
+    //The electrons of each hit, shared by all the showers in the event
+    const shower::ShowerCalibratedHitTable& calibratedHits =
+      IShowerTool::GetLArPandoraShowerAlg().GetCalibratedHitTable(Event,
+                                                                  fPFParticleLabel,
+                                                                  clockData,
+                                                                  detProp,
+                                                                  fCalorimetryAlg,
+                                                                  fCalorimetryAlgID,
+                                                                  ShowerEleHolder);
+
     for (auto const& [plane, hits] : planeHits) {
 
       unsigned int planeNumHits = hits.size();
 
       //Calculate the Energy for
-      double Energy = CalculateEnergy(clockData, detProp, hits, plane);
+      double Energy = CalculateEnergy(calibratedHits, hits);
       // If the energy is negative, leave it at -999
       if (Energy > 0) energyVec.at(plane) = Energy;
 
@@ -146,28 +157,22 @@ namespace ShowerRecoTools {
   }
 
   // function to calculate the reco energy
-  double ShowerNumElectronsEnergy::CalculateEnergy(const detinfo::DetectorClocksData& clockData,
-                                                   const detinfo::DetectorPropertiesData& detProp,
-                                                   const std::vector<art::Ptr<recob::Hit>>& hits,
-                                                   const geo::PlaneID::PlaneID_t plane) const
+  double ShowerNumElectronsEnergy::CalculateEnergy(
+    const shower::ShowerCalibratedHitTable& calibratedHits,
+    const std::vector<art::Ptr<recob::Hit>>& hits) const
   {
 
-    double totalCharge = 0;
+    double totalElectrons = 0;
     double totalEnergy = 0;
-    double correctedtotalCharge = 0;
     double nElectrons = 0;
 
     for (auto const& hit : hits) {
-      totalCharge +=
-        hit->Integral() *
-        fCalorimetryAlg.LifetimeCorrection(
-          clockData, detProp, hit->PeakTime()); // obtain charge and correct for lifetime
+      totalElectrons += calibratedHits.Electrons(hit); // lifetime corrected charge in electrons
     }
 
-    // correct charge due to recombination
-    correctedtotalCharge = totalCharge / fRecombinationFactor;
-    // calculate # of electrons and the corresponding energy
-    nElectrons = fCalorimetryAlg.ElectronsFromADCArea(correctedtotalCharge, plane);
+    // correct electrons due to recombination
+    nElectrons = totalElectrons / fRecombinationFactor;
+    // calculate the corresponding energy
     totalEnergy = (nElectrons / util::kGeVToElectrons) * 1000; // energy in MeV
     return totalEnergy;
   }
@@ -13,6 +13,7 @@
 #include "lardataobj/RecoBase/Hit.h"
 #include "lardataobj/RecoBase/SpacePoint.h"
 #include "lardataobj/RecoBase/Track.h"
+#include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Algs/ShowerTrajSpacePointMatcher.h"
 #include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Tools/IShowerTool.h"
 
 namespace ShowerRecoTools {
@@ -94,6 +95,16 @@ namespace ShowerRecoTools {
     recob::Track InitialTrack;
     ShowerEleHolder.GetElement(fInitialTrackInputTag, InitialTrack);
 
+    //Match each trajectory point to the closest spacepoint not matched before
+    std::vector<geo::Point_t> spacePointPositions;
+    spacePointPositions.reserve(intitaltrack_sp.size());
+    for (auto const& spacePoint : intitaltrack_sp) {
+      spacePointPositions.push_back(spacePoint->position());
+    }
+    shower::ShowerTrajSpacePointMatcher spacePointMatcher(spacePointPositions, fMaxDist);
+
+    const geo::Point_t TrajPositionStart = InitialTrack.LocationAtPoint(0);
+
     std::vector<art::Ptr<recob::SpacePoint>> new_intitaltrack_sp;
     //Loop over the trajectory points
     for (unsigned int traj = 0; traj < InitialTrack.NumberTrajectoryPoints(); ++traj) {
@@ -103,30 +114,16 @@ namespace ShowerRecoTools {
       if (flags.isSet(recob::TrajectoryPointFlagTraits::NoPoint)) { continue; }
 
       geo::Point_t TrajPosition = InitialTrack.LocationAtPoint(traj);
-      geo::Point_t TrajPositionStart = InitialTrack.LocationAtPoint(0);
 
       //Ignore values with 0 mag from the start position
       if ((TrajPosition - TrajPositionStart).R() == 0) { continue; }
       if ((TrajPosition - ShowerStartPosition).R() == 0) { continue; }
 
-      float MinDist = 9999;
-      unsigned int index = 999;
-      for (unsigned int sp = 0; sp < intitaltrack_sp.size(); ++sp) {
-        //Find the spacepoint closest to the trajectory point.
-        art::Ptr<recob::SpacePoint> spacepoint = intitaltrack_sp[sp];
-        auto const dist = (spacepoint->position() - TrajPosition).R();
-        if (dist < MinDist && dist < fMaxDist) {
-          MinDist = dist;
-          index = sp;
-        }
-      }
-
-      if (index == 999) { continue; }
-      //Add the spacepoint to the track spacepoints.
-      new_intitaltrack_sp.push_back(intitaltrack_sp[index]);
+      const size_t index = spacePointMatcher.Match(TrajPosition);
 
-      //Delete the spacepoint so it can not be used again.
-      intitaltrack_sp.erase(intitaltrack_sp.begin() + index);
+      if (index == spacePointMatcher.NumSpacePoints()) { continue; }
+      //Add the spacepoint to the track spacepoints. It is flagged so it can not be used again.
+      new_intitaltrack_sp.push_back(intitaltrack_sp[index]);
     }
 
     // Get the spacepoints
@@ -19,12 +19,16 @@
 #include "lardataobj/RecoBase/PFParticle.h"
 #include "lardataobj/RecoBase/SpacePoint.h"
 #include "lardataobj/RecoBase/Track.h"
+#include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Algs/ShowerPlaneGeometryTable.h"
 #include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Tools/IShowerTool.h"
 #include "larreco/Calorimetry/CalorimetryAlg.h"
 
 //ROOT
 #include "Math/VectorUtil.h"
 
+//C++ Includes
+#include <optional>
+
 using ROOT::Math::VectorUtil::Angle;
 
 namespace ShowerRecoTools {
@@ -46,6 +50,10 @@ namespace ShowerRecoTools {
     art::ServiceHandle<geo::Geometry> fGeom;
     calo::CalorimetryAlg fCalorimetryAlg;
 
+    //Wire plane pitches and directions, rebuilt when the run changes
+    std::optional<shower::ShowerPlaneGeometryTable> fPlaneGeometry;
+    art::RunNumber_t fPlaneGeometryRun;
+
     //fcl parameters
     float fMinAngleToWire; //Minimum angle between the wire direction and the shower
     //direction for the spacepoint to be used. Default means
@@ -87,6 +95,7 @@ namespace ShowerRecoTools {
   ShowerTrajPointdEdx::ShowerTrajPointdEdx(const fhicl::ParameterSet& pset)
     : IShowerTool(pset.get<fhicl::ParameterSet>("BaseTools"))
     , fCalorimetryAlg(pset.get<fhicl::ParameterSet>("CalorimetryAlg"))
+    , fPlaneGeometryRun(0)
     , fMinAngleToWire(pset.get<float>("MinAngleToWire"))
     , fShapingTime(pset.get<float>("ShapingTime"))
     , fMinDistCutOff(pset.get<float>("MinDistCutOff"))
@@ -124,6 +133,11 @@ namespace ShowerRecoTools {
     MaxDist = fMaxDist;
     dEdxTrackLength = fdEdxTrackLength;
 
+    if (!fPlaneGeometry || fPlaneGeometryRun != Event.run()) {
+      fPlaneGeometry.emplace(*fGeom);
+      fPlaneGeometryRun = Event.run();
+    }
+
     // Shower dEdx calculation
     if (!ShowerEleHolder.CheckElement(fShowerStartPositionInputLabel)) {
       if (fVerbose)
@@ -192,6 +206,8 @@ namespace ShowerRecoTools {
     auto const detProp =
       art::ServiceHandle<detinfo::DetectorPropertiesService const>()->DataFor(Event, clockData);
 
+    const double velocity = detProp.DriftVelocity(detProp.Efield(), detProp.Temperature());
+
     std::map<art::Ptr<recob::Hit>, std::vector<art::Ptr<recob::Hit>>> hitSnippets;
     if (fSumHitSnippets) {
       std::vector<art::Ptr<recob::Hit>> trackHits;
@@ -215,10 +231,11 @@ namespace ShowerRecoTools {
 
       if (fSumHitSnippets && !hitSnippets.count(hit)) continue;
 
-      double wirepitch = fGeom->WirePitch((geo::PlaneID)hit->WireID());
-
       //Only consider hits in the same tpc
       geo::PlaneID planeid = hit->WireID();
+      auto const& planeGeometry = fPlaneGeometry->GetPlane(planeid);
+      double wirepitch = planeGeometry.wirePitch;
+
       geo::TPCID TPC = planeid.asTPCID();
       if (TPC != vtxTPC) { continue; }
 
@@ -270,7 +287,7 @@ namespace ShowerRecoTools {
       // Note that we project in the YZ plane to make sure we are not cutting on
       // the angle into the wire planes, that should be done by the shaping time cut
       geo::Vector_t const TrajDirectionYZ{0, TrajDirection.Y(), TrajDirection.Z()};
-      auto const PlaneDirection = fGeom->Plane(planeid).GetIncreasingWireDirection();
+      auto const& PlaneDirection = planeGeometry.wireDirection;
 
       if (std::abs((TMath::Pi() / 2 - Angle(TrajDirectionYZ, PlaneDirection))) < fMinAngleToWire) {
         if (fVerbose) mf::LogWarning("ShowerTrajPointdEdx") << "remove from angle cut" << std::endl;
@@ -278,7 +295,6 @@ namespace ShowerRecoTools {
       }
 
       //If the direction is too much into the wire plane then the shaping amplifer cuts the charge. Lets remove these events.
-      double velocity = detProp.DriftVelocity(detProp.Efield(), detProp.Temperature());
       double distance_in_x = TrajDirection.X() * (wirepitch / TrajDirection.Dot(PlaneDirection));
       double time_taken = std::abs(distance_in_x / velocity);
 
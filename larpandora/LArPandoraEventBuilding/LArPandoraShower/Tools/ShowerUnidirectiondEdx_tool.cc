@@ -13,9 +13,13 @@
 //LArSoft Includes
 #include "lardata/DetectorInfoServices/DetectorClocksService.h"
 #include "lardata/DetectorInfoServices/DetectorPropertiesService.h"
+#include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Algs/ShowerPlaneGeometryTable.h"
 #include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Tools/IShowerTool.h"
 #include "larreco/Calorimetry/CalorimetryAlg.h"
 
+//C++ Includes
+#include <optional>
+
 namespace ShowerRecoTools {
 
   class ShowerUnidirectiondEdx : IShowerTool {
@@ -33,6 +37,10 @@ namespace ShowerRecoTools {
     art::ServiceHandle<geo::Geometry> fGeom;
     calo::CalorimetryAlg fCalorimetryAlg;
 
+    //Wire plane pitches and angles, rebuilt when the run changes
+    std::optional<shower::ShowerPlaneGeometryTable> fPlaneGeometry;
+    art::RunNumber_t fPlaneGeometryRun;
+
     //fcl parameters.
     int fVerbose;
     double fdEdxTrackLength,
@@ -50,6 +58,7 @@ namespace ShowerRecoTools {
   ShowerUnidirectiondEdx::ShowerUnidirectiondEdx(const fhicl::ParameterSet& pset)
     : IShowerTool(pset.get<fhicl::ParameterSet>("BaseTools"))
     , fCalorimetryAlg(pset.get<fhicl::ParameterSet>("CalorimetryAlg"))
+    , fPlaneGeometryRun(0)
     , fVerbose(pset.get<int>("Verbose"))
     , fdEdxTrackLength(pset.get<float>("dEdxTrackLength"))
     , fMaxHitPlane(pset.get<bool>("MaxHitPlane"))
@@ -69,6 +78,11 @@ namespace ShowerRecoTools {
 
     dEdxTrackLength = fdEdxTrackLength;
 
+    if (!fPlaneGeometry || fPlaneGeometryRun != Event.run()) {
+      fPlaneGeometry.emplace(*fGeom);
+      fPlaneGeometryRun = Event.run();
+    }
+
     // Shower dEdx calculation
     if (!ShowerEleHolder.CheckElement(fShowerStartPositionInputLabel)) {
       if (fVerbose)
@@ -132,7 +146,7 @@ namespace ShowerRecoTools {
       art::ServiceHandle<detinfo::DetectorPropertiesService const>()->DataFor(Event, clockData);
 
     for (unsigned int plane = 0; plane < numPlanes; ++plane) {
-      std::vector<art::Ptr<recob::Hit>> trackPlaneHits = trackHits.at(plane);
+      const std::vector<art::Ptr<recob::Hit>>& trackPlaneHits = trackHits.at(plane);
 
       std::map<art::Ptr<recob::Hit>, std::vector<art::Ptr<recob::Hit>>> hitSnippets;
       if (fSumHitSnippets)
@@ -146,13 +160,12 @@ namespace ShowerRecoTools {
         double pitch = 0;
 
         //Calculate the pitch
-        double wirepitch = fGeom->WirePitch(trackPlaneHits.at(0)->WireID().planeID());
-        double angleToVert =
-          fGeom->WireAngleToVertical(fGeom->Plane(geo::PlaneID{0, 0, plane}).View(),
-                                     trackPlaneHits[0]->WireID().planeID()) -
-          0.5 * TMath::Pi();
-        double cosgamma =
-          std::abs(std::sin(angleToVert) * showerDir.Y() + std::cos(angleToVert) * showerDir.Z());
+        const geo::PlaneID planeID = trackPlaneHits.at(0)->WireID().planeID();
+        double wirepitch = fPlaneGeometry->GetPlane(planeID).wirePitch;
+        auto const& anglePlane = fPlaneGeometry->FindPlane(
+          planeID.asTPCID(), fPlaneGeometry->GetPlane(geo::PlaneID{0, 0, plane}).view);
+        double cosgamma = std::abs(anglePlane.sinWireAngle * showerDir.Y() +
+                                   anglePlane.cosWireAngle * showerDir.Z());
 
         pitch = wirepitch / cosgamma;
 
@@ -216,7 +229,6 @@ namespace ShowerRecoTools {
       else { // if not (trackPlaneHits.size())
         dEdxVec.push_back(-999);
       }
-      trackPlaneHits.clear();
     } //end loop over planes
 
     //TODO
@@ -27,6 +27,7 @@
 #include "lardataobj/RecoBase/Slice.h"
 #include "lardataobj/RecoBase/SpacePoint.h"
 #include "lardataobj/RecoBase/Track.h"
+#include "lardataobj/RecoBase/TrackTrajectory.h"
 #include "lardataobj/RecoBase/Vertex.h"
 #include "lardataobj/RecoBase/Wire.h"
 #include "nusimdata/SimulationBase/MCTruth.h"
@@ -39,11 +40,713 @@
 #include "Pandora/PandoraInternal.h"
 #include "Pandora/PdgTable.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <limits>
+#include <memory>
+#include <unordered_map>
 
 namespace lar_pandora {
 
+  PFParticleHierarchy::PFParticleHierarchy(const PFParticleVector& particleVector)
+    : m_isIdIndex(true)
+  {
+    const size_t invalidIndex(std::numeric_limits<size_t>::max());
+
+    for (size_t i = 0; i < particleVector.size(); ++i) {
+      if (particleVector[i]->Self() != i) {
+        m_isIdIndex = false;
+        break;
+      }
+    }
+
+    if (m_isIdIndex) { m_particles = particleVector; }
+    else {
+      // Fallback for sparse IDs - as in LArPandoraHelper::BuildPFParticleMap, the last particle with a given ID wins
+      std::map<size_t, art::Ptr<recob::PFParticle>> idToParticle;
+      for (const art::Ptr<recob::PFParticle>& particle : particleVector)
+        idToParticle[particle->Self()] = particle;
+
+      for (const auto& idAndParticle : idToParticle) {
+        m_idToIndex.emplace(idAndParticle.first, m_particles.size());
+        m_particles.push_back(idAndParticle.second);
+      }
+    }
+
+    const size_t nIndices(m_particles.size());
+    m_parentIndices.assign(nIndices, invalidIndex);
+    m_finalStateIndices.assign(nIndices, invalidIndex);
+    m_generations.assign(nIndices, 0);
+
+    // Walk up from each unvisited particle until reaching a visited or top-level particle, then resolve the chain top-down
+    enum class State { kUnvisited, kInProgress, kResolved };
+    std::vector<State> states(nIndices, State::kUnvisited);
+    std::vector<size_t> chain;
+
+    for (size_t firstIndex = 0; firstIndex < nIndices; ++firstIndex) {
+      if (State::kUnvisited != states[firstIndex]) continue;
+
+      chain.clear();
+      size_t index(firstIndex);
+
+      while ((invalidIndex != index) && (State::kUnvisited == states[index])) {
+        states[index] = State::kInProgress;
+        chain.push_back(index);
+
+        if (m_particles[index]->IsPrimary()) break;
+
+        index = this->FindIndex(m_particles[index]->Parent());
+      }
+
+      for (auto iter = chain.rbegin(); iter != chain.rend(); ++iter) {
+        const size_t thisIndex(*iter);
+        const art::Ptr<recob::PFParticle>& particle(m_particles[thisIndex]);
+        states[thisIndex] = State::kResolved;
+
+        if (particle->IsPrimary()) {
+          m_parentIndices[thisIndex] = thisIndex;
+          m_finalStateIndices[thisIndex] = thisIndex;
+          m_generations[thisIndex] = 1;
+          continue;
+        }
+
+        // ATTN a parent that is missing, or that is part of a loop, leaves this particle unresolved
+        const size_t parentIndex(this->FindIndex(particle->Parent()));
+        if (invalidIndex == parentIndex) continue;
+
+        if (LArPandoraHelper::IsNeutrino(m_particles[parentIndex]))
+          m_finalStateIndices[thisIndex] = thisIndex;
+
+        if (State::kResolved != states[parentIndex]) continue;
+
+        m_parentIndices[thisIndex] = m_parentIndices[parentIndex];
+
+        if (invalidIndex == m_finalStateIndices[thisIndex])
+          m_finalStateIndices[thisIndex] = m_finalStateIndices[parentIndex];
+
+        if (m_generations[parentIndex] > 0)
+          m_generations[thisIndex] = m_generations[parentIndex] + 1;
+      }
+    }
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  const art::Ptr<recob::PFParticle>& PFParticleHierarchy::GetParentPFParticle(
+    const art::Ptr<recob::PFParticle>& daughterParticle) const
+  {
+    const size_t index(m_parentIndices.at(
+      this->GetIndex(daughterParticle->Self(), "PFParticleHierarchy::GetParentPFParticle")));
+
+    if (index >= m_particles.size())
+      throw cet::exception("LArPandora") << " PFParticleHierarchy::GetParentPFParticle --- Found "
+                                            "a PFParticle without a particle ID ";
+
+    return m_particles[index];
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  const art::Ptr<recob::PFParticle>& PFParticleHierarchy::GetFinalStatePFParticle(
+    const art::Ptr<recob::PFParticle>& daughterParticle) const
+  {
+    const size_t index(m_finalStateIndices.at(
+      this->GetIndex(daughterParticle->Self(), "PFParticleHierarchy::GetFinalStatePFParticle")));
+
+    if (index >= m_particles.size())
+      throw cet::exception("LArPandora") << " PFParticleHierarchy::GetFinalStatePFParticle --- "
+                                            "Found a PFParticle without a particle ID ";
+
+    return m_particles[index];
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  int PFParticleHierarchy::GetGeneration(const art::Ptr<recob::PFParticle>& daughterParticle) const
+  {
+    const int nGenerations(m_generations.at(
+      this->GetIndex(daughterParticle->Self(), "PFParticleHierarchy::GetGeneration")));
+
+    if (nGenerations <= 0)
+      throw cet::exception("LArPandora")
+        << " PFParticleHierarchy::GetGeneration --- Found a PFParticle without a particle ID ";
+
+    return nGenerations;
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  int PFParticleHierarchy::GetParentNeutrino(
+    const art::Ptr<recob::PFParticle>& daughterParticle) const
+  {
+    const art::Ptr<recob::PFParticle>& parentParticle(this->GetParentPFParticle(daughterParticle));
+
+    return (LArPandoraHelper::IsNeutrino(parentParticle) ? parentParticle->PdgCode() : 0);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  bool PFParticleHierarchy::IsFinalState(const art::Ptr<recob::PFParticle>& daughterParticle) const
+  {
+    if (LArPandoraHelper::IsNeutrino(daughterParticle)) return false;
+
+    if (daughterParticle->IsPrimary()) return true;
+
+    const size_t parentIndex(
+      this->GetIndex(daughterParticle->Parent(), "PFParticleHierarchy::IsFinalState"));
+
+    return LArPandoraHelper::IsNeutrino(m_particles[parentIndex]);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  size_t PFParticleHierarchy::GetIndex(const size_t particleId,
+                                       const std::string& functionName) const
+  {
+    const size_t index(this->FindIndex(particleId));
+
+    if (index >= m_particles.size())
+      throw cet::exception("LArPandora")
+        << " " << functionName << " --- Found a PFParticle without a particle ID ";
+
+    return index;
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  size_t PFParticleHierarchy::FindIndex(const size_t particleId) const
+  {
+    if (m_isIdIndex)
+      return ((particleId < m_particles.size()) ? particleId : std::numeric_limits<size_t>::max());
+
+    const std::map<size_t, size_t>::const_iterator it(m_idToIndex.find(particleId));
+    return ((m_idToIndex.end() != it) ? it->second : std::numeric_limits<size_t>::max());
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  size_t PFParticleHitIndex::GetNParticles() const { return m_particles.size(); }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  const art::Ptr<recob::PFParticle>& PFParticleHitIndex::GetParticle(
+    const size_t particleIndex) const
+  {
+    return m_particles.at(particleIndex);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  HitVector::const_iterator PFParticleHitIndex::HitsBegin(const size_t particleIndex) const
+  {
+    return m_hits.begin() + m_hitOffsets.at(particleIndex);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  HitVector::const_iterator PFParticleHitIndex::HitsEnd(const size_t particleIndex) const
+  {
+    return m_hits.begin() + m_hitOffsets.at(particleIndex + 1);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  bool PFParticleHitIndex::GetParticleIndex(const art::Ptr<recob::Hit>& hit,
+                                            size_t& particleIndex) const
+  {
+    for (size_t i = 0; i < m_hitProductIds.size(); ++i) {
+      if (m_hitProductIds[i] != hit.id()) continue;
+
+      const std::vector<size_t>& hitKeyToParticleIndex(m_hitKeyToParticleIndices[i]);
+      if ((hit.key() >= hitKeyToParticleIndex.size()) ||
+          (hitKeyToParticleIndex[hit.key()] >= m_particles.size()))
+        return false;
+
+      particleIndex = hitKeyToParticleIndex[hit.key()];
+      return true;
+    }
+
+    return false;
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  void PFParticleHitIndex::FillMaps(PFParticlesToHits& particlesToHits,
+                                    HitsToPFParticles& hitsToParticles) const
+  {
+    for (size_t i = 0; i < m_particles.size(); ++i) {
+      if (m_hitOffsets[i] == m_hitOffsets[i + 1]) continue;
+
+      HitVector& hitVector(particlesToHits[m_particles[i]]);
+      hitVector.insert(hitVector.end(), this->HitsBegin(i), this->HitsEnd(i));
+
+      // ATTN a hit shared between particles is mapped to the last one, as for the index itself
+      for (HitVector::const_iterator iter = this->HitsBegin(i); iter != this->HitsEnd(i); ++iter) {
+        size_t particleIndex(i);
+        this->GetParticleIndex(*iter, particleIndex);
+        hitsToParticles[*iter] = m_particles[particleIndex];
+      }
+    }
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  size_t HitTrackIDEIndex::GetNHits() const { return m_hits.size(); }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  const art::Ptr<recob::Hit>& HitTrackIDEIndex::GetHit(const size_t hitIndex) const
+  {
+    return m_hits.at(hitIndex);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  TrackIDEVector::const_iterator HitTrackIDEIndex::TrackIDEsBegin(const size_t hitIndex) const
+  {
+    return m_trackIDEs.begin() + m_trackIDEOffsets.at(hitIndex);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  TrackIDEVector::const_iterator HitTrackIDEIndex::TrackIDEsEnd(const size_t hitIndex) const
+  {
+    return m_trackIDEs.begin() + m_trackIDEOffsets.at(hitIndex + 1);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  void HitTrackIDEIndex::FillMap(HitsToTrackIDEs& hitsToTrackIDEs) const
+  {
+    for (size_t i = 0; i < m_hits.size(); ++i) {
+      if (this->TrackIDEsBegin(i) == this->TrackIDEsEnd(i)) continue;
+
+      TrackIDEVector& trackIDEs(hitsToTrackIDEs[m_hits[i]]);
+      trackIDEs.insert(trackIDEs.end(), this->TrackIDEsBegin(i), this->TrackIDEsEnd(i));
+    }
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  PFParticleProductLoader::PFParticleProductLoader(const std::string& particleLabel,
+                                                   const std::string& clusterLabel,
+                                                   const std::string& spacePointLabel,
+                                                   const std::string& trackLabel,
+                                                   const std::string& showerLabel,
+                                                   const unsigned int products)
+    : m_particleLabel(particleLabel)
+    , m_clusterLabel(clusterLabel)
+    , m_spacePointLabel(spacePointLabel)
+    , m_trackLabel(trackLabel)
+    , m_showerLabel(showerLabel)
+    , m_products(products)
+  {}
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  void PFParticleProductLoader::Load(const art::Event& evt)
+  {
+    m_particleVector.clear();
+    m_particlesToClusters.clear();
+    m_clusterVector.clear();
+    m_clustersToHits.clear();
+    m_particlesToSpacePoints.clear();
+    m_spacePointVector.clear();
+    m_spacePointsToHits.clear();
+    m_vertexVector.clear();
+    m_particlesToVertices.clear();
+    m_t0Vector.clear();
+    m_particlesToT0s.clear();
+    m_trackVector.clear();
+    m_particlesToTracks.clear();
+    m_tracksToHits.clear();
+    m_showerVector.clear();
+    m_particlesToShowers.clear();
+    m_showersToHits.clear();
+
+    this->LoadPFParticles(evt);
+
+    if (m_products & kClusters) this->LoadClusters(evt);
+
+    if (m_products & kSpacePoints) this->LoadSpacePoints(evt);
+
+    if (m_products & kVertices) this->LoadVertices(evt);
+
+    if (m_products & kT0s) this->LoadT0s(evt);
+
+    if (m_products & kTracks) this->LoadTracks(evt);
+
+    if (m_products & kShowers) this->LoadShowers(evt);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  void PFParticleProductLoader::BuildPFParticleHitMaps(
+    PFParticlesToHits& particlesToHits,
+    HitsToPFParticles& hitsToParticles,
+    const LArPandoraHelper::DaughterMode daughterMode,
+    const bool useClusters) const
+  {
+    if (useClusters) {
+      this->CheckRequested(kClusters, "BuildPFParticleHitMaps");
+      LArPandoraHelper::BuildPFParticleHitMaps(m_particleVector,
+                                               m_particlesToClusters,
+                                               m_clustersToHits,
+                                               particlesToHits,
+                                               hitsToParticles,
+                                               daughterMode);
+    }
+    else {
+      this->CheckRequested(kSpacePoints, "BuildPFParticleHitMaps");
+      LArPandoraHelper::BuildPFParticleHitMaps(m_particleVector,
+                                               m_particlesToSpacePoints,
+                                               m_spacePointsToHits,
+                                               particlesToHits,
+                                               hitsToParticles,
+                                               daughterMode);
+    }
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  void PFParticleProductLoader::CheckRequested(const Product product,
+                                               const std::string& functionName) const
+  {
+    if (!(m_products & product))
+      throw cet::exception("LArPandora")
+        << " PFParticleProductLoader::" << functionName
+        << " --- the required products were not requested from the loader ";
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  void PFParticleProductLoader::LoadPFParticles(const art::Event& evt)
+  {
+    art::Handle<std::vector<recob::PFParticle>> theParticles;
+    evt.getByLabel(m_particleLabel, theParticles);
+
+    if (!theParticles.isValid()) {
+      mf::LogDebug("LArPandora") << "  Failed to find particles... " << std::endl;
+      return;
+    }
+    else {
+      mf::LogDebug("LArPandora") << "  Found: " << theParticles->size() << " PFParticles "
+                                 << std::endl;
+    }
+
+    std::unique_ptr<art::FindManyP<recob::Cluster>> theClusterAssns(
+      (m_products & kClusters) ?
+        new art::FindManyP<recob::Cluster>(theParticles, evt, m_particleLabel) :
+        nullptr);
+    std::unique_ptr<art::FindManyP<recob::SpacePoint>> theSpacePointAssns(
+      (m_products & kSpacePoints) ?
+        new art::FindManyP<recob::SpacePoint>(theParticles, evt, m_particleLabel) :
+        nullptr);
+
+    m_particleVector.reserve(theParticles->size());
+
+    for (unsigned int i = 0; i < theParticles->size(); ++i) {
+      const art::Ptr<recob::PFParticle> particle(theParticles, i);
+      m_particleVector.push_back(particle);
+
+      if (theClusterAssns) {
+        for (const art::Ptr<recob::Cluster>& cluster : theClusterAssns->at(i))
+          m_particlesToClusters[particle].push_back(cluster);
+      }
+
+      if (theSpacePointAssns) {
+        for (const art::Ptr<recob::SpacePoint>& spacepoint : theSpacePointAssns->at(i))
+          m_particlesToSpacePoints[particle].push_back(spacepoint);
+      }
+    }
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  void PFParticleProductLoader::LoadClusters(const art::Event& evt)
+  {
+    LArPandoraHelper::CollectClusters(evt, m_clusterLabel, m_clusterVector, m_clustersToHits);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  void PFParticleProductLoader::LoadSpacePoints(const art::Event& evt)
+  {
+    LArPandoraHelper::CollectSpacePoints(
+      evt, m_spacePointLabel, m_spacePointVector, m_spacePointsToHits);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  void PFParticleProductLoader::LoadVertices(const art::Event& evt)
+  {
+    LArPandoraHelper::CollectVertices(
+      evt, m_particleLabel, m_vertexVector, m_particlesToVertices);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  void PFParticleProductLoader::LoadT0s(const art::Event& evt)
+  {
+    LArPandoraHelper::CollectT0s(evt, m_particleLabel, m_t0Vector, m_particlesToT0s);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  void PFParticleProductLoader::LoadTracks(const art::Event& evt)
+  {
+    art::Handle<std::vector<recob::Track>> theTracks;
+    evt.getByLabel(m_trackLabel, theTracks);
+
+    if (!theTracks.isValid()) {
+      mf::LogDebug("LArPandora") << "  Failed to find tracks... " << std::endl;
+      return;
+    }
+    else {
+      mf::LogDebug("LArPandora") << "  Found: " << theTracks->size() << " Tracks " << std::endl;
+    }
+
+    const art::FindManyP<recob::PFParticle> theParticleAssns(theTracks, evt, m_trackLabel);
+    const art::FindManyP<recob::Hit> theHitAssns(theTracks, evt, m_trackLabel);
+
+    m_trackVector.reserve(theTracks->size());
+
+    for (unsigned int i = 0; i < theTracks->size(); ++i) {
+      const art::Ptr<recob::Track> track(theTracks, i);
+      m_trackVector.push_back(track);
+
+      for (const art::Ptr<recob::PFParticle>& particle : theParticleAssns.at(i))
+        m_particlesToTracks[particle].push_back(track);
+
+      for (const art::Ptr<recob::Hit>& hit : theHitAssns.at(i))
+        m_tracksToHits[track].push_back(hit);
+    }
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  void PFParticleProductLoader::LoadShowers(const art::Event& evt)
+  {
+    art::Handle<std::vector<recob::Shower>> theShowers;
+    evt.getByLabel(m_showerLabel, theShowers);
+
+    if (!theShowers.isValid()) {
+      mf::LogDebug("LArPandora") << "  Failed to find showers... " << std::endl;
+      return;
+    }
+    else {
+      mf::LogDebug("LArPandora") << "  Found: " << theShowers->size() << " Showers " << std::endl;
+    }
+
+    const art::FindManyP<recob::PFParticle> theParticleAssns(theShowers, evt, m_showerLabel);
+    const art::FindManyP<recob::Hit> theHitAssns(theShowers, evt, m_showerLabel);
+
+    m_showerVector.reserve(theShowers->size());
+
+    for (unsigned int i = 0; i < theShowers->size(); ++i) {
+      const art::Ptr<recob::Shower> shower(theShowers, i);
+      m_showerVector.push_back(shower);
+
+      for (const art::Ptr<recob::PFParticle>& particle : theParticleAssns.at(i))
+        m_particlesToShowers[particle].push_back(shower);
+
+      for (const art::Ptr<recob::Hit>& hit : theHitAssns.at(i))
+        m_showersToHits[shower].push_back(hit);
+    }
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  TrackTrajectoryArrays::TrackTrajectoryArrays()
+    : m_nValidPoints(0)
+    , m_minX(0.0)
+    , m_maxX(0.0)
+    , m_minY(0.0)
+    , m_maxY(0.0)
+    , m_minZ(0.0)
+    , m_maxZ(0.0)
+  {}
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  void TrackTrajectoryArrays::Fill(const recob::TrackTrajectory& trajectory)
+  {
+    const size_t nPoints(trajectory.NumberTrajectoryPoints());
+
+    m_x.resize(nPoints);
+    m_y.resize(nPoints);
+    m_z.resize(nPoints);
+    m_directionX.resize(nPoints);
+    m_directionY.resize(nPoints);
+    m_directionZ.resize(nPoints);
+    m_isValid.resize(nPoints);
+    m_residualRange.resize(nPoints);
+
+    m_nValidPoints = 0;
+    m_minX = std::numeric_limits<double>::max();
+    m_maxX = std::numeric_limits<double>::lowest();
+    m_minY = std::numeric_limits<double>::max();
+    m_maxY = std::numeric_limits<double>::lowest();
+    m_minZ = std::numeric_limits<double>::max();
+    m_maxZ = std::numeric_limits<double>::lowest();
+
+    for (size_t p = 0; p < nPoints; ++p) {
+      const recob::TrackTrajectory::Point_t& position(trajectory.LocationAtPoint(p));
+      const recob::TrackTrajectory::Vector_t direction(trajectory.DirectionAtPoint(p));
+
+      m_x[p] = position.X();
+      m_y[p] = position.Y();
+      m_z[p] = position.Z();
+      m_directionX[p] = direction.X();
+      m_directionY[p] = direction.Y();
+      m_directionZ[p] = direction.Z();
+      m_isValid[p] = trajectory.HasValidPoint(p);
+    }
+
+    for (size_t p = 0; p < nPoints; ++p) {
+      if (!m_isValid[p]) continue;
+
+      ++m_nValidPoints;
+      m_minX = std::min(m_minX, m_x[p]);
+      m_maxX = std::max(m_maxX, m_x[p]);
+      m_minY = std::min(m_minY, m_y[p]);
+      m_maxY = std::max(m_maxY, m_y[p]);
+      m_minZ = std::min(m_minZ, m_z[p]);
+      m_maxZ = std::max(m_maxZ, m_z[p]);
+    }
+
+    // Accumulate the distances between consecutive valid points backwards from the end; as for
+    // recob::TrackTrajectory::Length(point), an invalid point takes the residual range of the next valid point
+    double residualRange(0.0);
+    size_t nextValidPoint(nPoints);
+
+    for (size_t p = nPoints; p-- > 0;) {
+      if (m_isValid[p]) {
+        if (nextValidPoint < nPoints) {
+          const double dx(m_x[nextValidPoint] - m_x[p]);
+          const double dy(m_y[nextValidPoint] - m_y[p]);
+          const double dz(m_z[nextValidPoint] - m_z[p]);
+          residualRange += std::sqrt(dx * dx + dy * dy + dz * dz);
+        }
+
+        nextValidPoint = p;
+      }
+
+      m_residualRange[p] = residualRange;
+    }
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  HitChargeWeight::HitChargeWeight(const HitVector& hits)
+  {
+    m_charges.reserve(hits.size());
+
+    for (const art::Ptr<recob::Hit>& hit : hits)
+      m_charges.push_back(hit->Integral());
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  template <typename WeightPolicy>
+  RecoTrueOverlapTable<WeightPolicy>::RecoTrueOverlapTable(
+    const std::vector<size_t>& hitsToTrueIndex,
+    const size_t nTrueObjects,
+    const WeightPolicy& weightPolicy)
+    : m_hitsToTrueIndex(hitsToTrueIndex)
+    , m_weightPolicy(weightPolicy)
+    , m_trueWeights(nTrueObjects, 0)
+    , m_sharedWeights(nTrueObjects, 0)
+    , m_isShared(nTrueObjects, 0)
+  {
+    for (size_t hitIndex = 0; hitIndex < m_hitsToTrueIndex.size(); ++hitIndex) {
+      const size_t trueIndex(m_hitsToTrueIndex[hitIndex]);
+
+      if (LArPandoraHelper::kNoTrueIndex == trueIndex) continue;
+
+      if (trueIndex >= nTrueObjects)
+        throw cet::exception("LArPandora")
+          << " RecoTrueOverlapTable --- hit refers to a true object outside the table";
+
+      m_trueWeights[trueIndex] += m_weightPolicy(hitIndex);
+    }
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  template <typename WeightPolicy>
+  size_t RecoTrueOverlapTable<WeightPolicy>::AddRecoObject(const std::vector<size_t>& recoHitIndices)
+  {
+    WeightType recoWeight(0);
+
+    for (const size_t hitIndex : recoHitIndices) {
+      const WeightType weight(m_weightPolicy(hitIndex));
+      const size_t trueIndex(m_hitsToTrueIndex.at(hitIndex));
+
+      recoWeight += weight;
+
+      if (LArPandoraHelper::kNoTrueIndex == trueIndex) continue;
+
+      if (!m_isShared[trueIndex]) {
+        m_isShared[trueIndex] = 1;
+        m_sharedTrueIndices.push_back(trueIndex);
+      }
+
+      m_sharedWeights[trueIndex] += weight;
+    }
+
+    // Read out and reset only the touched entries of the accumulator
+    std::sort(m_sharedTrueIndices.begin(), m_sharedTrueIndices.end());
+
+    OverlapVector overlaps;
+    overlaps.reserve(m_sharedTrueIndices.size());
+
+    for (const size_t trueIndex : m_sharedTrueIndices) {
+      overlaps.emplace_back(trueIndex, m_sharedWeights[trueIndex]);
+      m_sharedWeights[trueIndex] = 0;
+      m_isShared[trueIndex] = 0;
+    }
+
+    m_sharedTrueIndices.clear();
+    m_recoWeights.push_back(recoWeight);
+    m_overlaps.push_back(std::move(overlaps));
+
+    return (m_overlaps.size() - 1);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  template <typename WeightPolicy>
+  float RecoTrueOverlapTable<WeightPolicy>::GetPurity(const size_t recoIndex,
+                                                      const TrueIndexAndWeight& overlap) const
+  {
+    const WeightType recoWeight(this->GetRecoWeight(recoIndex));
+
+    return ((recoWeight > 0) ? static_cast<float>(overlap.second) / static_cast<float>(recoWeight) :
+                               0.f);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  template <typename WeightPolicy>
+  float RecoTrueOverlapTable<WeightPolicy>::GetCompleteness(const TrueIndexAndWeight& overlap) const
+  {
+    const WeightType trueWeight(this->GetTrueWeight(overlap.first));
+
+    return ((trueWeight > 0) ? static_cast<float>(overlap.second) / static_cast<float>(trueWeight) :
+                               0.f);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
   void LArPandoraHelper::CollectWires(const art::Event& evt,
                                       const std::string& label,
                                       WireVector& wireVector)
@@ -512,16 +1215,8 @@ namespace lar_pandora {
     HitsToPFParticles& hitsToParticles,
     const DaughterMode daughterMode)
   {
-    // Build mapping from particle to particle ID for parent/daughter navigation
-    PFParticleMap particleMap;
-
-    for (PFParticleVector::const_iterator iter1 = particleVector.begin(),
-                                          iterEnd1 = particleVector.end();
-         iter1 != iterEnd1;
-         ++iter1) {
-      const art::Ptr<recob::PFParticle> particle = *iter1;
-      particleMap[particle->Self()] = particle;
-    }
+    // Build the particle hierarchy once for parent/daughter navigation
+    const PFParticleHierarchy particleHierarchy(particleVector);
 
     // Loop over hits and build mapping between reconstructed final-state particles and reconstructed hits
     for (PFParticlesToSpacePoints::const_iterator iter1 = particlesToSpacePoints.begin(),
@@ -531,11 +1226,11 @@ namespace lar_pandora {
       const art::Ptr<recob::PFParticle> thisParticle = iter1->first;
       const art::Ptr<recob::PFParticle> particle(
         (kAddDaughters == daughterMode) ?
-          LArPandoraHelper::GetFinalStatePFParticle(particleMap, thisParticle) :
+          LArPandoraHelper::GetFinalStatePFParticle(particleHierarchy, thisParticle) :
           thisParticle);
 
       if ((kIgnoreDaughters == daughterMode) &&
-          !LArPandoraHelper::IsFinalState(particleMap, particle))
+          !LArPandoraHelper::IsFinalState(particleHierarchy, particle))
         continue;
 
       const SpacePointVector& spacePointVector = iter1->second;
@@ -568,16 +1263,8 @@ namespace lar_pandora {
                                                 HitsToPFParticles& hitsToParticles,
                                                 const DaughterMode daughterMode)
   {
-    // Build mapping from particle to particle ID for parent/daughter navigation
-    PFParticleMap particleMap;
-
-    for (PFParticleVector::const_iterator iter1 = particleVector.begin(),
-                                          iterEnd1 = particleVector.end();
-         iter1 != iterEnd1;
-         ++iter1) {
-      const art::Ptr<recob::PFParticle> particle = *iter1;
-      particleMap[particle->Self()] = particle;
-    }
+    // Build the particle hierarchy once for parent/daughter navigation
+    const PFParticleHierarchy particleHierarchy(particleVector);
 
     // Loop over hits and build mapping between reconstructed final-state particles and reconstructed hits
     for (PFParticlesToClusters::const_iterator iter1 = particlesToClusters.begin(),
@@ -587,11 +1274,11 @@ namespace lar_pandora {
       const art::Ptr<recob::PFParticle> thisParticle = iter1->first;
       const art::Ptr<recob::PFParticle> particle(
         (kAddDaughters == daughterMode) ?
-          LArPandoraHelper::GetFinalStatePFParticle(particleMap, thisParticle) :
+          LArPandoraHelper::GetFinalStatePFParticle(particleHierarchy, thisParticle) :
           thisParticle);
 
       if ((kIgnoreDaughters == daughterMode) &&
-          !LArPandoraHelper::IsFinalState(particleMap, particle))
+          !LArPandoraHelper::IsFinalState(particleHierarchy, particle))
         continue;
 
       const ClusterVector& clusterVector = iter1->second;
@@ -642,43 +1329,153 @@ namespace lar_pandora {
                                                 const DaughterMode daughterMode,
                                                 const bool useClusters)
   {
-    // Use intermediate clusters
-    if (useClusters) {
-      PFParticleVector particleVector;
-      PFParticlesToClusters particlesToClusters;
+    PFParticleHitIndex hitIndex;
+    LArPandoraHelper::BuildPFParticleHitIndex(
+      evt, label_pfpart, label_middle, hitIndex, daughterMode, useClusters);
+    hitIndex.FillMaps(particlesToHits, hitsToParticles);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
 
-      ClusterVector clusterVector;
-      ClustersToHits clustersToHits;
+  void LArPandoraHelper::BuildPFParticleHitIndex(const art::Event& evt,
+                                                 const std::string& label_pfpart,
+                                                 const std::string& label_middle,
+                                                 PFParticleHitIndex& hitIndex,
+                                                 const DaughterMode daughterMode,
+                                                 const bool useClusters)
+  {
+    if (!hitIndex.m_particles.empty())
+      throw cet::exception("LArPandora")
+        << " PandoraCollector::BuildPFParticleHitIndex --- the input index is not empty ";
 
-      LArPandoraHelper::CollectPFParticles(evt, label_pfpart, particleVector, particlesToClusters);
-      LArPandoraHelper::CollectClusters(evt, label_middle, clusterVector, clustersToHits);
+    art::Handle<std::vector<recob::PFParticle>> theParticles;
+    evt.getByLabel(label_pfpart, theParticles);
 
-      LArPandoraHelper::BuildPFParticleHitMaps(particleVector,
-                                               particlesToClusters,
-                                               clustersToHits,
-                                               particlesToHits,
-                                               hitsToParticles,
-                                               daughterMode);
+    if (!theParticles.isValid()) {
+      mf::LogDebug("LArPandora") << "  Failed to find particles... " << std::endl;
+      return;
     }
 
-    // Use intermediate space points
+    const size_t nParticles(theParticles->size());
+    for (size_t i = 0; i < nParticles; ++i)
+      hitIndex.m_particles.emplace_back(theParticles, i);
+
+    std::unique_ptr<art::FindManyP<recob::Cluster>> theClusterAssns(
+      useClusters ? new art::FindManyP<recob::Cluster>(theParticles, evt, label_pfpart) : nullptr);
+    std::unique_ptr<art::FindManyP<recob::SpacePoint>> theSpacePointAssns(
+      useClusters ? nullptr :
+                    new art::FindManyP<recob::SpacePoint>(theParticles, evt, label_pfpart));
+
+    // Find the particle that absorbs the hits of each input particle with intermediate objects (if any)
+    const size_t invalidIndex(std::numeric_limits<size_t>::max());
+    const PFParticleHierarchy particleHierarchy(hitIndex.m_particles);
+    std::vector<size_t> outputIndices(nParticles, invalidIndex);
+
+    for (size_t i = 0; i < nParticles; ++i) {
+      if (useClusters ? theClusterAssns->at(i).empty() : theSpacePointAssns->at(i).empty())
+        continue;
+
+      const art::Ptr<recob::PFParticle>& thisParticle(hitIndex.m_particles[i]);
+      const art::Ptr<recob::PFParticle>& particle(
+        (kAddDaughters == daughterMode) ?
+          particleHierarchy.GetFinalStatePFParticle(thisParticle) :
+          thisParticle);
+
+      if ((kIgnoreDaughters == daughterMode) && !particleHierarchy.IsFinalState(particle))
+        continue;
+
+      outputIndices[i] = particle.key();
+    }
+
+    // Collect the hits of each particle that is kept through the intermediate objects, in the order of the associations
+    // ATTN as in BuildPFParticleHitMaps, the intermediate objects of particles that are not kept are not checked
+    std::vector<HitVector> particleHits(nParticles);
+
+    if (useClusters) {
+      art::Handle<std::vector<recob::Cluster>> theClusters;
+      evt.getByLabel(label_middle, theClusters);
+
+      std::unique_ptr<art::FindManyP<recob::Hit>> theHitAssns(
+        theClusters.isValid() ? new art::FindManyP<recob::Hit>(theClusters, evt, label_middle) :
+                                nullptr);
+
+      for (size_t i = 0; i < nParticles; ++i) {
+        if (invalidIndex == outputIndices[i]) continue;
+
+        for (const art::Ptr<recob::Cluster>& cluster : theClusterAssns->at(i)) {
+          // ATTN as for the cluster to hit map, clusters without hits are not allowed
+          if (!theHitAssns || (cluster.id() != theClusters.id()) ||
+              theHitAssns->at(cluster.key()).empty())
+            throw cet::exception("LArPandora") << " PandoraCollector::BuildPFParticleHitIndex --- "
+                                                  "Found a cluster without an associated hit ";
+
+          const std::vector<art::Ptr<recob::Hit>>& hits(theHitAssns->at(cluster.key()));
+          particleHits[i].insert(particleHits[i].end(), hits.begin(), hits.end());
+        }
+      }
+    }
     else {
-      PFParticleVector particleVector;
-      PFParticlesToSpacePoints particlesToSpacePoints;
+      art::Handle<std::vector<recob::SpacePoint>> theSpacePoints;
+      evt.getByLabel(label_middle, theSpacePoints);
 
-      SpacePointVector spacePointVector;
-      SpacePointsToHits spacePointsToHits;
+      std::unique_ptr<art::FindOneP<recob::Hit>> theHitAssns(
+        theSpacePoints.isValid() ?
+          new art::FindOneP<recob::Hit>(theSpacePoints, evt, label_middle) :
+          nullptr);
 
-      LArPandoraHelper::CollectPFParticles(
-        evt, label_pfpart, particleVector, particlesToSpacePoints);
-      LArPandoraHelper::CollectSpacePoints(evt, label_middle, spacePointVector, spacePointsToHits);
+      for (size_t i = 0; i < nParticles; ++i) {
+        if (invalidIndex == outputIndices[i]) continue;
 
-      LArPandoraHelper::BuildPFParticleHitMaps(particleVector,
-                                               particlesToSpacePoints,
-                                               spacePointsToHits,
-                                               particlesToHits,
-                                               hitsToParticles,
-                                               daughterMode);
+        for (const art::Ptr<recob::SpacePoint>& spacepoint : theSpacePointAssns->at(i)) {
+          if (!theHitAssns || (spacepoint.id() != theSpacePoints.id()))
+            throw cet::exception("LArPandora") << " PandoraCollector::BuildPFParticleHitIndex --- "
+                                                  "Found a space point without an associated hit ";
+
+          particleHits[i].push_back(theHitAssns->at(spacepoint.key()));
+        }
+      }
+    }
+
+    // First pass, count the hits of each output particle to find the offset of its range
+    hitIndex.m_hitOffsets.assign(nParticles + 1, 0);
+    for (size_t i = 0; i < nParticles; ++i) {
+      if (invalidIndex != outputIndices[i])
+        hitIndex.m_hitOffsets[outputIndices[i] + 1] += particleHits[i].size();
+    }
+
+    for (size_t i = 0; i < nParticles; ++i)
+      hitIndex.m_hitOffsets[i + 1] += hitIndex.m_hitOffsets[i];
+
+    // Second pass, fill the hit ranges and the mapping from hit key to particle index
+    hitIndex.m_hits.resize(hitIndex.m_hitOffsets.back());
+    std::vector<size_t> nextHits(hitIndex.m_hitOffsets.begin(), hitIndex.m_hitOffsets.end() - 1);
+
+    for (size_t i = 0; i < nParticles; ++i) {
+      const size_t outputIndex(outputIndices[i]);
+      if (invalidIndex == outputIndex) continue;
+
+      for (const art::Ptr<recob::Hit>& hit : particleHits[i]) {
+        hitIndex.m_hits[nextHits[outputIndex]++] = hit;
+
+        // ATTN null hits (space points without a hit) can't be looked up by key
+        if (hit.isNull()) continue;
+
+        const auto productIter(std::find(
+          hitIndex.m_hitProductIds.begin(), hitIndex.m_hitProductIds.end(), hit.id()));
+        const size_t productIndex(productIter - hitIndex.m_hitProductIds.begin());
+
+        if (hitIndex.m_hitProductIds.end() == productIter) {
+          hitIndex.m_hitProductIds.push_back(hit.id());
+          hitIndex.m_hitKeyToParticleIndices.emplace_back();
+        }
+
+        std::vector<size_t>& hitKeyToParticleIndex(
+          hitIndex.m_hitKeyToParticleIndices[productIndex]);
+        if (hit.key() >= hitKeyToParticleIndex.size())
+          hitKeyToParticleIndex.resize(hit.key() + 1, invalidIndex);
+
+        hitKeyToParticleIndex[hit.key()] = outputIndex;
+      }
     }
   }
 
@@ -702,16 +1499,8 @@ namespace lar_pandora {
   void LArPandoraHelper::SelectFinalStatePFParticles(const PFParticleVector& inputParticles,
                                                      PFParticleVector& outputParticles)
   {
-    // Build mapping from particle to particle ID for parent/daughter navigation
-    PFParticleMap particleMap;
-
-    for (PFParticleVector::const_iterator iter = inputParticles.begin(),
-                                          iterEnd = inputParticles.end();
-         iter != iterEnd;
-         ++iter) {
-      const art::Ptr<recob::PFParticle> particle = *iter;
-      particleMap[particle->Self()] = particle;
-    }
+    // Build the particle hierarchy once for parent/daughter navigation
+    const PFParticleHierarchy particleHierarchy(inputParticles);
 
     // Select final-state particles
     for (PFParticleVector::const_iterator iter = inputParticles.begin(),
@@ -720,7 +1509,7 @@ namespace lar_pandora {
          ++iter) {
       const art::Ptr<recob::PFParticle> particle = *iter;
 
-      if (LArPandoraHelper::IsFinalState(particleMap, particle))
+      if (LArPandoraHelper::IsFinalState(particleHierarchy, particle))
         outputParticles.push_back(particle);
     }
   }
@@ -947,66 +1736,103 @@ namespace lar_pandora {
     for (MCTruthToMCParticles::const_iterator iter1 = truthToParticles.begin(),
                                               iterEnd1 = truthToParticles.end();
          iter1 != iterEnd1;
-         ++iter1) {
-      const MCParticleVector& particleVector = iter1->second;
-      for (MCParticleVector::const_iterator iter2 = particleVector.begin(),
-                                            iterEnd2 = particleVector.end();
-           iter2 != iterEnd2;
-           ++iter2) {
-        const art::Ptr<simb::MCParticle> particle = *iter2;
-        particleMap[particle->TrackId()] = particle;
-      }
-    }
+         ++iter1)
+      LArPandoraHelper::BuildMCParticleMap(iter1->second, particleMap);
 
     // Loop over hits and build mapping between reconstructed hits and true particles
     for (HitsToTrackIDEs::const_iterator iter1 = hitsToTrackIDEs.begin(),
                                          iterEnd1 = hitsToTrackIDEs.end();
          iter1 != iterEnd1;
          ++iter1) {
-      const art::Ptr<recob::Hit> hit = iter1->first;
-      const TrackIDEVector& trackCollection = iter1->second;
+      LArPandoraHelper::AddMCParticleHitMatch(iter1->first,
+                                              iter1->second.begin(),
+                                              iter1->second.end(),
+                                              particleMap,
+                                              particlesToHits,
+                                              hitsToParticles,
+                                              daughterMode);
+    }
+  }
 
-      int bestTrackID(-1);
-      float bestEnergyFrac(0.f);
+  //------------------------------------------------------------------------------------------------------------------------------------------
 
-      for (TrackIDEVector::const_iterator iter2 = trackCollection.begin(),
-                                          iterEnd2 = trackCollection.end();
-           iter2 != iterEnd2;
-           ++iter2) {
-        const sim::TrackIDE& trackIDE = *iter2;
-        const int trackID(std::abs(trackIDE.trackID)); // TODO: Find out why std::abs is needed
-        const float energyFrac(trackIDE.energyFrac);
+  void LArPandoraHelper::BuildMCParticleHitMaps(const HitTrackIDEIndex& hitTrackIDEIndex,
+                                                const MCTruthToMCParticles& truthToParticles,
+                                                MCParticlesToHits& particlesToHits,
+                                                HitsToMCParticles& hitsToParticles,
+                                                const DaughterMode daughterMode)
+  {
+    // Build mapping between particles and track IDs for parent/daughter navigation
+    MCParticleMap particleMap;
 
-        if (energyFrac > bestEnergyFrac) {
-          bestEnergyFrac = energyFrac;
-          bestTrackID = trackID;
-        }
-      }
+    for (MCTruthToMCParticles::const_iterator iter1 = truthToParticles.begin(),
+                                              iterEnd1 = truthToParticles.end();
+         iter1 != iterEnd1;
+         ++iter1)
+      LArPandoraHelper::BuildMCParticleMap(iter1->second, particleMap);
+
+    // Loop over hits, in the same order as the hit map, and match each hit to its true particle
+    for (size_t hitIndex = 0; hitIndex < hitTrackIDEIndex.GetNHits(); ++hitIndex) {
+      if (hitTrackIDEIndex.TrackIDEsBegin(hitIndex) == hitTrackIDEIndex.TrackIDEsEnd(hitIndex))
+        continue;
 
-      if (bestTrackID >= 0) {
-        MCParticleMap::const_iterator iter3 = particleMap.find(bestTrackID);
-        if (particleMap.end() == iter3)
-          throw cet::exception("LArPandora") << " PandoraCollector::BuildMCParticleHitMaps --- "
-                                                "Found a track ID without an MC Particle ";
+      LArPandoraHelper::AddMCParticleHitMatch(hitTrackIDEIndex.GetHit(hitIndex),
+                                              hitTrackIDEIndex.TrackIDEsBegin(hitIndex),
+                                              hitTrackIDEIndex.TrackIDEsEnd(hitIndex),
+                                              particleMap,
+                                              particlesToHits,
+                                              hitsToParticles,
+                                              daughterMode);
+    }
+  }
 
-        try {
-          const art::Ptr<simb::MCParticle> thisParticle = iter3->second;
-          const art::Ptr<simb::MCParticle> primaryParticle(
-            LArPandoraHelper::GetFinalStateMCParticle(particleMap, thisParticle));
-          const art::Ptr<simb::MCParticle> selectedParticle(
-            (kAddDaughters == daughterMode) ? primaryParticle : thisParticle);
+  //------------------------------------------------------------------------------------------------------------------------------------------
 
-          if ((kIgnoreDaughters == daughterMode) && (selectedParticle != primaryParticle)) continue;
+  void LArPandoraHelper::AddMCParticleHitMatch(const art::Ptr<recob::Hit>& hit,
+                                               const TrackIDEVector::const_iterator trackIDEBegin,
+                                               const TrackIDEVector::const_iterator trackIDEEnd,
+                                               const MCParticleMap& particleMap,
+                                               MCParticlesToHits& particlesToHits,
+                                               HitsToMCParticles& hitsToParticles,
+                                               const DaughterMode daughterMode)
+  {
+    int bestTrackID(-1);
+    float bestEnergyFrac(0.f);
 
-          if (!(LArPandoraHelper::IsVisible(selectedParticle))) continue;
+    for (TrackIDEVector::const_iterator iter = trackIDEBegin; iter != trackIDEEnd; ++iter) {
+      const sim::TrackIDE& trackIDE = *iter;
+      const int trackID(std::abs(trackIDE.trackID)); // TODO: Find out why std::abs is needed
+      const float energyFrac(trackIDE.energyFrac);
 
-          particlesToHits[selectedParticle].push_back(hit);
-          hitsToParticles[hit] = selectedParticle;
-        }
-        catch (cet::exception& e) {
-        }
+      if (energyFrac > bestEnergyFrac) {
+        bestEnergyFrac = energyFrac;
+        bestTrackID = trackID;
       }
     }
+
+    if (bestTrackID < 0) return;
+
+    MCParticleMap::const_iterator pIter = particleMap.find(bestTrackID);
+    if (particleMap.end() == pIter)
+      throw cet::exception("LArPandora") << " PandoraCollector::BuildMCParticleHitMaps --- "
+                                            "Found a track ID without an MC Particle ";
+
+    try {
+      const art::Ptr<simb::MCParticle> thisParticle = pIter->second;
+      const art::Ptr<simb::MCParticle> primaryParticle(
+        LArPandoraHelper::GetFinalStateMCParticle(particleMap, thisParticle));
+      const art::Ptr<simb::MCParticle> selectedParticle(
+        (kAddDaughters == daughterMode) ? primaryParticle : thisParticle);
+
+      if ((kIgnoreDaughters == daughterMode) && (selectedParticle != primaryParticle)) return;
+
+      if (!(LArPandoraHelper::IsVisible(selectedParticle))) return;
+
+      particlesToHits[selectedParticle].push_back(hit);
+      hitsToParticles[hit] = selectedParticle;
+    }
+    catch (cet::exception& e) {
+    }
   }
 
   //------------------------------------------------------------------------------------------------------------------------------------------
@@ -1039,6 +1865,22 @@ namespace lar_pandora {
                                                 const std::string& backtrackLabel,
                                                 HitsToTrackIDEs& hitsToTrackIDEs)
   {
+    HitTrackIDEIndex hitTrackIDEIndex;
+    LArPandoraHelper::BuildHitTrackIDEIndex(evt, hitLabel, backtrackLabel, hitTrackIDEIndex);
+    hitTrackIDEIndex.FillMap(hitsToTrackIDEs);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  void LArPandoraHelper::BuildHitTrackIDEIndex(const art::Event& evt,
+                                               const std::string& hitLabel,
+                                               const std::string& backtrackLabel,
+                                               HitTrackIDEIndex& hitTrackIDEIndex)
+  {
+    if (!hitTrackIDEIndex.m_hits.empty())
+      throw cet::exception("LArPandora")
+        << " PandoraCollector::BuildHitTrackIDEIndex --- the input index is not empty ";
+
     // Start by getting the collection of Hits
     art::Handle<std::vector<recob::Hit>> theHits;
     evt.getByLabel(hitLabel, theHits);
@@ -1048,46 +1890,49 @@ namespace lar_pandora {
       return;
     }
 
-    HitVector hitVector;
-
-    for (unsigned int i = 0; i < theHits->size(); ++i) {
-      const art::Ptr<recob::Hit> hit(theHits, i);
-      hitVector.push_back(hit);
-    }
-
     // Now get the associations between Hits and MCParticles
-    std::vector<anab::BackTrackerHitMatchingData const*> backtrackerVector;
-
-    MCParticleVector particleVector;
+    typedef art::Assns<recob::Hit, simb::MCParticle, anab::BackTrackerHitMatchingData>
+      HitToMCParticleAssns;
 
-    art::FindManyP<simb::MCParticle, anab::BackTrackerHitMatchingData> particles_per_hit(
-      theHits, evt, backtrackLabel);
+    art::Handle<HitToMCParticleAssns> theAssns;
+    evt.getByLabel(backtrackLabel, theAssns);
 
-    if (!particles_per_hit.isValid()) {
+    if (!theAssns.isValid()) {
       mf::LogDebug("LArPandora") << "  Failed to find reco-truth matching... " << std::endl;
       return;
     }
 
-    // Now loop over the hits and build a collection of IDEs
-    for (HitVector::const_iterator iter = hitVector.begin(), iterEnd = hitVector.end();
-         iter != iterEnd;
-         ++iter) {
-      const art::Ptr<recob::Hit> hit = *iter;
+    const size_t nHits(theHits->size());
+    hitTrackIDEIndex.m_hits.reserve(nHits);
+    for (size_t i = 0; i < nHits; ++i)
+      hitTrackIDEIndex.m_hits.emplace_back(theHits, i);
 
-      particleVector.clear();
-      backtrackerVector.clear();
-      particles_per_hit.get(hit.key(), particleVector, backtrackerVector);
+    // First pass, count the true energy deposits of each hit to find the offset of its range
+    std::vector<size_t>& offsets(hitTrackIDEIndex.m_trackIDEOffsets);
+    offsets.assign(nHits + 1, 0);
 
-      for (unsigned int j = 0; j < particleVector.size(); ++j) {
-        const art::Ptr<simb::MCParticle> particle = particleVector[j];
+    for (const HitToMCParticleAssns::assn_t& assn : *theAssns) {
+      if ((assn.first.id() == theHits.id()) && (assn.first.key() < nHits))
+        ++offsets[assn.first.key() + 1];
+    }
 
-        sim::TrackIDE trackIDE;
-        trackIDE.trackID = particle->TrackId();
-        trackIDE.energy = backtrackerVector[j]->energy;
-        trackIDE.energyFrac = backtrackerVector[j]->ideFraction;
+    for (size_t i = 0; i < nHits; ++i)
+      offsets[i + 1] += offsets[i];
 
-        hitsToTrackIDEs[hit].push_back(trackIDE);
-      }
+    // Second pass, fill the true energy deposits in the order of the associations
+    hitTrackIDEIndex.m_trackIDEs.resize(offsets.back());
+    std::vector<size_t> nextTrackIDEs(offsets.begin(), offsets.end() - 1);
+
+    for (size_t i = 0; i < theAssns->size(); ++i) {
+      const art::Ptr<recob::Hit>& hit((*theAssns)[i].first);
+      if ((hit.id() != theHits.id()) || (hit.key() >= nHits)) continue;
+
+      const anab::BackTrackerHitMatchingData& backtrackerData(theAssns->data(i));
+
+      sim::TrackIDE& trackIDE(hitTrackIDEIndex.m_trackIDEs[nextTrackIDEs[hit.key()]++]);
+      trackIDE.trackID = (*theAssns)[i].second->TrackId();
+      trackIDE.energy = backtrackerData.energy;
+      trackIDE.energyFrac = backtrackerData.ideFraction;
     }
   }
 
@@ -1103,12 +1948,12 @@ namespace lar_pandora {
   {
     MCTruthToMCParticles truthToParticles;
     MCParticlesToMCTruth particlesToTruth;
-    HitsToTrackIDEs hitsToTrackIDEs;
+    HitTrackIDEIndex hitTrackIDEIndex;
 
     LArPandoraHelper::CollectMCParticles(evt, truthLabel, truthToParticles, particlesToTruth);
-    LArPandoraHelper::BuildMCParticleHitMaps(evt, hitLabel, backtrackLabel, hitsToTrackIDEs);
+    LArPandoraHelper::BuildHitTrackIDEIndex(evt, hitLabel, backtrackLabel, hitTrackIDEIndex);
     LArPandoraHelper::BuildMCParticleHitMaps(
-      hitsToTrackIDEs, truthToParticles, particlesToHits, hitsToParticles, daughterMode);
+      hitTrackIDEIndex, truthToParticles, particlesToHits, hitsToParticles, daughterMode);
   }
 
   //------------------------------------------------------------------------------------------------------------------------------------------
@@ -1148,6 +1993,171 @@ namespace lar_pandora {
 
   //------------------------------------------------------------------------------------------------------------------------------------------
 
+  template <typename T>
+  void LArPandoraHelper::BuildRecoTrueHitIndices(
+    const PFParticlesToHits& recoToHits,
+    const std::map<art::Ptr<recob::Hit>, art::Ptr<T>>& hitsToTrue,
+    PFParticleVector& recoParticles,
+    std::vector<std::vector<size_t>>& recoHitIndices,
+    std::vector<art::Ptr<T>>& trueObjects,
+    HitVector& hits,
+    std::vector<size_t>& hitsToTrueIndex)
+  {
+    recoParticles.clear();
+    recoHitIndices.clear();
+    trueObjects.clear();
+    hits.clear();
+    hitsToTrueIndex.clear();
+
+    // Index the true objects in increasing order
+    trueObjects.reserve(hitsToTrue.size());
+    for (const auto& hitToTrue : hitsToTrue)
+      trueObjects.push_back(hitToTrue.second);
+
+    std::sort(trueObjects.begin(), trueObjects.end());
+    trueObjects.erase(std::unique(trueObjects.begin(), trueObjects.end()), trueObjects.end());
+
+    // Number the hits of the true objects first, then any other hits of the reconstructed particles
+    std::unordered_map<art::Ptr<recob::Hit>, size_t> hitsToIndex;
+    hitsToIndex.reserve(hitsToTrue.size());
+    hits.reserve(hitsToTrue.size());
+    hitsToTrueIndex.reserve(hitsToTrue.size());
+
+    for (const auto& hitToTrue : hitsToTrue) {
+      hitsToIndex[hitToTrue.first] = hits.size();
+      hits.push_back(hitToTrue.first);
+      hitsToTrueIndex.push_back(
+        std::lower_bound(trueObjects.begin(), trueObjects.end(), hitToTrue.second) -
+        trueObjects.begin());
+    }
+
+    recoParticles.reserve(recoToHits.size());
+    recoHitIndices.reserve(recoToHits.size());
+
+    for (const PFParticlesToHits::value_type& recoToHitsEntry : recoToHits) {
+      recoParticles.push_back(recoToHitsEntry.first);
+      recoHitIndices.emplace_back();
+
+      std::vector<size_t>& hitIndices(recoHitIndices.back());
+      hitIndices.reserve(recoToHitsEntry.second.size());
+
+      for (const art::Ptr<recob::Hit>& hit : recoToHitsEntry.second) {
+        const auto insertion(hitsToIndex.emplace(hit, hits.size()));
+
+        if (insertion.second) {
+          hits.push_back(hit);
+          hitsToTrueIndex.push_back(kNoTrueIndex);
+        }
+
+        hitIndices.push_back(insertion.first->second);
+      }
+    }
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  template <typename T>
+  void LArPandoraHelper::MatchRecoToTrue(
+    const PFParticlesToHits& recoToHits,
+    const std::map<art::Ptr<recob::Hit>, art::Ptr<T>>& trueHitsToTrue,
+    const bool recursiveMatching,
+    std::map<art::Ptr<T>, art::Ptr<recob::PFParticle>>& matchedObjects,
+    std::map<art::Ptr<T>, HitVector>& matchedHits)
+  {
+    matchedObjects.clear();
+    matchedHits.clear();
+
+    const size_t invalidIndex(std::numeric_limits<size_t>::max());
+
+    // Number the hits and index the true objects in the ordering of the output maps, which decides between equal hit counts
+    PFParticleVector recoObjects;
+    std::vector<std::vector<size_t>> recoHitIndices;
+    std::vector<art::Ptr<T>> trueObjects;
+    HitVector hits;
+    std::vector<size_t> hitsToTrueIndex;
+    LArPandoraHelper::BuildRecoTrueHitIndices(
+      recoToHits, trueHitsToTrue, recoObjects, recoHitIndices, trueObjects, hits, hitsToTrueIndex);
+
+    // Build the sparse shared hit count matrix, each row sorted by decreasing hit count then by true index
+    typedef RecoTrueOverlapTable<>::TrueIndexAndWeight TrueIndexAndCount;
+
+    const size_t nReco(recoObjects.size()), nTrue(trueObjects.size());
+    RecoTrueOverlapTable<> overlapTable(hitsToTrueIndex, nTrue);
+    std::vector<RecoTrueOverlapTable<>::OverlapVector> sharedHitMatrix(nReco);
+
+    for (size_t recoIndex = 0; recoIndex < nReco; ++recoIndex) {
+      RecoTrueOverlapTable<>::OverlapVector& row(sharedHitMatrix[recoIndex]);
+      row = overlapTable.GetOverlaps(overlapTable.AddRecoObject(recoHitIndices[recoIndex]));
+
+      std::stable_sort(row.begin(),
+                       row.end(),
+                       [](const TrueIndexAndCount& lhs, const TrueIndexAndCount& rhs) {
+                         return (lhs.second > rhs.second);
+                       });
+    }
+
+    // Greedy matching rounds; vetoes only grow, so each row is consumed in order, as a priority queue
+    std::vector<bool> recoVeto(nReco, false), trueVeto(nTrue, false);
+    std::vector<size_t> rowPositions(nReco, 0);
+    std::vector<size_t> trueToRecoIndex(nTrue, invalidIndex), trueToSharedHits(nTrue, 0);
+
+    while (true) {
+      bool foundMatches(false);
+
+      for (size_t recoIndex = 0; recoIndex < nReco; ++recoIndex) {
+        if (recoVeto[recoIndex]) continue;
+
+        const std::vector<TrueIndexAndCount>& row(sharedHitMatrix[recoIndex]);
+        size_t& rowPosition(rowPositions[recoIndex]);
+
+        while ((rowPosition < row.size()) && trueVeto[row[rowPosition].first])
+          ++rowPosition;
+
+        if (rowPosition == row.size()) continue;
+
+        const size_t trueIndex(row[rowPosition].first), nSharedHits(row[rowPosition].second);
+
+        if ((invalidIndex == trueToRecoIndex[trueIndex]) ||
+            (nSharedHits > trueToSharedHits[trueIndex])) {
+          trueToRecoIndex[trueIndex] = recoIndex;
+          trueToSharedHits[trueIndex] = nSharedHits;
+          foundMatches = true;
+        }
+      }
+
+      if (!foundMatches) break;
+
+      for (size_t trueIndex = 0; trueIndex < nTrue; ++trueIndex) {
+        if (invalidIndex == trueToRecoIndex[trueIndex]) continue;
+
+        trueVeto[trueIndex] = true;
+        recoVeto[trueToRecoIndex[trueIndex]] = true;
+      }
+
+      if (!recursiveMatching) break;
+    }
+
+    // Store the shared hits of the final matches only
+    for (size_t trueIndex = 0; trueIndex < nTrue; ++trueIndex) {
+      const size_t recoIndex(trueToRecoIndex[trueIndex]);
+      if (invalidIndex == recoIndex) continue;
+
+      const art::Ptr<T>& trueObject(trueObjects[trueIndex]);
+      const HitVector& hitVector(recoToHits.at(recoObjects[recoIndex]));
+      HitVector& sharedHits(matchedHits[trueObject]);
+
+      matchedObjects[trueObject] = recoObjects[recoIndex];
+      sharedHits.reserve(trueToSharedHits[trueIndex]);
+
+      for (size_t hitIndex = 0; hitIndex < hitVector.size(); ++hitIndex) {
+        if (hitsToTrueIndex[recoHitIndices[recoIndex][hitIndex]] == trueIndex)
+          sharedHits.push_back(hitVector[hitIndex]);
+      }
+    }
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
   void LArPandoraHelper::BuildMCParticleMap(const MCParticleVector& particleVector,
                                             MCParticleMap& particleMap)
   {
@@ -1247,6 +2257,24 @@ namespace lar_pandora {
 
   //------------------------------------------------------------------------------------------------------------------------------------------
 
+  art::Ptr<recob::PFParticle> LArPandoraHelper::GetParentPFParticle(
+    const PFParticleHierarchy& particleHierarchy,
+    const art::Ptr<recob::PFParticle> inputParticle)
+  {
+    return particleHierarchy.GetParentPFParticle(inputParticle);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  art::Ptr<recob::PFParticle> LArPandoraHelper::GetFinalStatePFParticle(
+    const PFParticleHierarchy& particleHierarchy,
+    const art::Ptr<recob::PFParticle> inputParticle)
+  {
+    return particleHierarchy.GetFinalStatePFParticle(inputParticle);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
   art::Ptr<simb::MCParticle> LArPandoraHelper::GetParentMCParticle(
     const MCParticleMap& particleMap,
     const art::Ptr<simb::MCParticle> inputParticle)
@@ -1356,6 +2384,14 @@ namespace lar_pandora {
 
   //------------------------------------------------------------------------------------------------------------------------------------------
 
+  int LArPandoraHelper::GetGeneration(const PFParticleHierarchy& particleHierarchy,
+                                      const art::Ptr<recob::PFParticle> inputParticle)
+  {
+    return particleHierarchy.GetGeneration(inputParticle);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
   int LArPandoraHelper::GetParentNeutrino(const PFParticleMap& particleMap,
                                           const art::Ptr<recob::PFParticle> daughterParticle)
   {
@@ -1379,6 +2415,14 @@ namespace lar_pandora {
 
   //------------------------------------------------------------------------------------------------------------------------------------------
 
+  int LArPandoraHelper::GetParentNeutrino(const PFParticleHierarchy& particleHierarchy,
+                                          const art::Ptr<recob::PFParticle> daughterParticle)
+  {
+    return particleHierarchy.GetParentNeutrino(daughterParticle);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
   bool LArPandoraHelper::IsFinalState(const PFParticleMap& particleMap,
                                       const art::Ptr<recob::PFParticle> daughterParticle)
   {
@@ -1402,6 +2446,14 @@ namespace lar_pandora {
 
   //------------------------------------------------------------------------------------------------------------------------------------------
 
+  bool LArPandoraHelper::IsFinalState(const PFParticleHierarchy& particleHierarchy,
+                                      const art::Ptr<recob::PFParticle> daughterParticle)
+  {
+    return particleHierarchy.IsFinalState(daughterParticle);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
   bool LArPandoraHelper::IsNeutrino(const art::Ptr<recob::PFParticle> particle)
   {
     const int pdg(particle->PdgCode());
@@ -1474,4 +2526,35 @@ namespace lar_pandora {
                                                     HitVector&,
                                                     const pandora::IntVector* const);
 
+  template void LArPandoraHelper::BuildRecoTrueHitIndices(const PFParticlesToHits&,
+                                                          const HitsToMCParticles&,
+                                                          PFParticleVector&,
+                                                          std::vector<std::vector<size_t>>&,
+                                                          MCParticleVector&,
+                                                          HitVector&,
+                                                          std::vector<size_t>&);
+
+  template void LArPandoraHelper::BuildRecoTrueHitIndices(const PFParticlesToHits&,
+                                                          const HitsToMCTruth&,
+                                                          PFParticleVector&,
+                                                          std::vector<std::vector<size_t>>&,
+                                                          MCTruthVector&,
+                                                          HitVector&,
+                                                          std::vector<size_t>&);
+
+  template void LArPandoraHelper::MatchRecoToTrue(const PFParticlesToHits&,
+                                                  const HitsToMCParticles&,
+                                                  const bool,
+                                                  MCParticlesToPFParticles&,
+                                                  MCParticlesToHits&);
+
+  template void LArPandoraHelper::MatchRecoToTrue(const PFParticlesToHits&,
+                                                  const HitsToMCTruth&,
+                                                  const bool,
+                                                  MCTruthToPFParticles&,
+                                                  MCTruthToHits&);
+
+  template class RecoTrueOverlapTable<HitCountWeight>;
+  template class RecoTrueOverlapTable<HitChargeWeight>;
+
 } // namespace lar_pandora
@@ -13,9 +13,12 @@ namespace art {
 
 #include "canvas/Persistency/Common/Ptr.h"
 
+#include <limits>
 #include <map>
 #include <set>
+#include <string>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace anab {
@@ -36,6 +39,7 @@ namespace recob {
   class Slice;
   class SpacePoint;
   class Track;
+  class TrackTrajectory;
   class Vertex;
   class Wire;
 }
@@ -115,6 +119,101 @@ namespace lar_pandora {
   typedef std::map<const pandora::Vertex*, unsigned int> ThreeDVertexMap;
   typedef std::map<int, HitVector> HitArray;
 
+  /**
+ *  @brief  PFParticleHierarchy class, precomputed navigation of the parent/daughter links in a collection of PFParticles
+ *
+ *  The Pandora output sets the ID of each PFParticle to its position in the collection, in which case the particles are
+ *  indexed by ID directly; a map from ID to index is only built as a fallback for collections with sparse IDs.
+ */
+  class PFParticleHierarchy {
+  public:
+    /**
+     *  @brief  Constructor, resolves the hierarchy of every input particle in a single pass
+     *
+     *  @param  particleVector the input vector of reconstructed particles
+     */
+    explicit PFParticleHierarchy(const PFParticleVector& particleVector);
+
+    /**
+     *  @brief  Return the top-level parent particle
+     *
+     *  @param  daughterParticle the input PF particle
+     *
+     *  @return the top-level parent particle
+     */
+    const art::Ptr<recob::PFParticle>& GetParentPFParticle(
+      const art::Ptr<recob::PFParticle>& daughterParticle) const;
+
+    /**
+     *  @brief  Return the final-state parent particle
+     *
+     *  @param  daughterParticle the input PF particle
+     *
+     *  @return the final-state parent particle
+     */
+    const art::Ptr<recob::PFParticle>& GetFinalStatePFParticle(
+      const art::Ptr<recob::PFParticle>& daughterParticle) const;
+
+    /**
+     *  @brief  Return the generation of this particle (first generation if primary)
+     *
+     *  @param  daughterParticle the input daughter particle
+     *
+     *  @return the nth generation in the particle hierarchy
+     */
+    int GetGeneration(const art::Ptr<recob::PFParticle>& daughterParticle) const;
+
+    /**
+     *  @brief  Return the parent neutrino PDG code (or zero for cosmics) for a given reconstructed particle
+     *
+     *  @param  daughterParticle the input daughter particle
+     *
+     *  @return the PDG code of the parent neutrinos (or zero for cosmics)
+     */
+    int GetParentNeutrino(const art::Ptr<recob::PFParticle>& daughterParticle) const;
+
+    /**
+     *  @brief  Determine whether a particle has been reconstructed as a final-state particle
+     *
+     *  @param  daughterParticle the input daughter particle
+     *
+     *  @return true/false
+     */
+    bool IsFinalState(const art::Ptr<recob::PFParticle>& daughterParticle) const;
+
+  private:
+    /**
+     *  @brief  Get the index of a particle in the hierarchy, throw an exception if it can't be found
+     *
+     *  @param  particleId the particle ID
+     *  @param  functionName the name of the calling function, for the exception message
+     *
+     *  @return the index of the particle
+     */
+    size_t GetIndex(const size_t particleId, const std::string& functionName) const;
+
+    /**
+     *  @brief  Find the index of a particle in the hierarchy
+     *
+     *  @param  particleId the particle ID
+     *
+     *  @return the index of the particle, or an invalid index if it can't be found
+     */
+    size_t FindIndex(const size_t particleId) const;
+
+    std::vector<art::Ptr<recob::PFParticle>> m_particles; ///< The particles, in order of increasing ID
+    bool m_isIdIndex; ///< Whether the ID of each particle is its index
+    std::map<size_t, size_t> m_idToIndex; ///< Fallback mapping from particle ID to index, for sparse IDs
+    std::vector<size_t>
+      m_parentIndices; ///< The index of the top-level parent of each particle (invalid if it can't be reached)
+    std::vector<size_t>
+      m_finalStateIndices; ///< The index of the final-state parent of each particle (invalid if it can't be reached)
+    std::vector<int> m_generations; ///< The generation of each particle (zero if it can't be reached)
+  };
+
+  class HitTrackIDEIndex;
+  class PFParticleHitIndex;
+
   /**
  *  @brief  LArPandoraHelper class
  */
@@ -129,6 +228,9 @@ namespace lar_pandora {
       kAddDaughters = 2     // Absorb daughter particles into parent particles
     };
 
+    static constexpr size_t kNoTrueIndex =
+      std::numeric_limits<size_t>::max(); ///< The true object index of a hit without a true object
+
     /**
      *  @brief Collect the reconstructed wires from the ART event record
      *
@@ -401,6 +503,23 @@ namespace lar_pandora {
                                        const DaughterMode daughterMode = kUseDaughters,
                                        const bool useClusters = true);
 
+    /**
+     *  @brief Build a compressed index between PFParticles and Hits, reading the association products from the ART event record
+     *
+     *  @param evt the ART event record
+     *  @param label_pfpart the label for the PFParticle list in the event
+     *  @param label_mid the label for the Intermediate list in the event
+     *  @param hitIndex the output index between PFParticle and Hit objects
+     *  @param daughterMode treatment of daughter particles in construction of the index
+     *  @param useClusters choice of intermediate object (true for Clusters, false for SpacePoints)
+     */
+    static void BuildPFParticleHitIndex(const art::Event& evt,
+                                        const std::string& label_pfpart,
+                                        const std::string& label_mid,
+                                        PFParticleHitIndex& hitIndex,
+                                        const DaughterMode daughterMode = kUseDaughters,
+                                        const bool useClusters = true);
+
     /**
      *  @brief Collect a vector of cosmic tags from the ART event record
      *
@@ -504,6 +623,21 @@ namespace lar_pandora {
                                        HitsToMCParticles& hitsToParticles,
                                        const DaughterMode daughterMode = kUseDaughters);
 
+    /**
+     *  @brief Build mapping between Hits and MCParticles, starting from a flat Hit/TrackIDE index and MCParticle information
+     *
+     *  @param hitTrackIDEIndex the input index from hits to true energy deposits
+     *  @param truthToParticles the input map of truth information
+     *  @param particlesToHits the mapping between true particles and reconstructed hits
+     *  @param hitsToParticles the mapping between reconstructed hits and true particles
+     *  @param daughterMode treatment of daughter particles in construction of maps
+     */
+    static void BuildMCParticleHitMaps(const HitTrackIDEIndex& hitTrackIDEIndex,
+                                       const MCTruthToMCParticles& truthToParticles,
+                                       MCParticlesToHits& particlesToHits,
+                                       HitsToMCParticles& hitsToParticles,
+                                       const DaughterMode daughterMode = kUseDaughters);
+
     /**
      *  @brief Build mapping between Hits and MCParticles, starting from ART event record
      *
@@ -534,6 +668,19 @@ namespace lar_pandora {
                                        const std::string& backtrackLabel,
                                        HitsToTrackIDEs& hitsToTrackIDEs);
 
+    /**
+     *  @brief  Build a flat index between hits and true energy deposits, in a single pass over the back-tracker associations
+     *
+     *  @param  evt the event record
+     *  @param  hitLabel the label of the collection of hits
+     *  @param  backtrackLabel the label of the collection of back-tracker information
+     *  @param  hitTrackIDEIndex the output index between hits and true energy deposits
+     */
+    static void BuildHitTrackIDEIndex(const art::Event& evt,
+                                      const std::string& hitLabel,
+                                      const std::string& backtrackLabel,
+                                      HitTrackIDEIndex& hitTrackIDEIndex);
+
     /**
      *  @brief Build mapping between Hits and MCParticles, starting from Hit/TrackIDE/MCParticle information
      *
@@ -569,6 +716,47 @@ namespace lar_pandora {
                                   HitVector& associatedHits,
                                   const pandora::IntVector* const indexVector = nullptr);
 
+    /**
+     *  @brief  Number the hits of reconstructed particles and true objects densely, as needed by RecoTrueOverlapTable
+     *
+     *  @param  recoToHits the mapping from reconstructed particles to hits
+     *  @param  hitsToTrue the mapping from hits to true objects
+     *  @param  recoParticles the output reconstructed particles, in the ordering of the input mapping
+     *  @param  recoHitIndices the output indices of the hits of each reconstructed particle, in the ordering of its hits
+     *  @param  trueObjects the output true objects, in increasing order
+     *  @param  hits the output hits, in the ordering of their indices
+     *  @param  hitsToTrueIndex the output index in trueObjects of the true object of each hit (or kNoTrueIndex)
+     */
+    template <typename T>
+    static void BuildRecoTrueHitIndices(
+      const PFParticlesToHits& recoToHits,
+      const std::map<art::Ptr<recob::Hit>, art::Ptr<T>>& hitsToTrue,
+      PFParticleVector& recoParticles,
+      std::vector<std::vector<size_t>>& recoHitIndices,
+      std::vector<art::Ptr<T>>& trueObjects,
+      HitVector& hits,
+      std::vector<size_t>& hitsToTrueIndex);
+
+    /**
+     *  @brief  Perform greedy matching between true and reconstructed objects, using a reco-true shared hit count matrix
+     *
+     *  Each reconstructed object is matched to the true object with which it shares most hits; a true object keeps the
+     *  reconstructed object with most shared hits. Equal hit counts are decided by the ordering of the maps. With
+     *  recursive matching, matched objects are vetoed and the matching is repeated until no further matches are found.
+     *
+     *  @param  recoToHits the mapping from reconstructed objects to hits
+     *  @param  trueHitsToTrue the mapping from hits to true objects
+     *  @param  recursiveMatching whether to repeat the matching for the objects left unmatched
+     *  @param  matchedObjects the output matches between true and reconstructed objects
+     *  @param  matchedHits the output matches between true objects and the shared hits of the reconstructed objects
+     */
+    template <typename T>
+    static void MatchRecoToTrue(const PFParticlesToHits& recoToHits,
+                                const std::map<art::Ptr<recob::Hit>, art::Ptr<T>>& trueHitsToTrue,
+                                const bool recursiveMatching,
+                                std::map<art::Ptr<T>, art::Ptr<recob::PFParticle>>& matchedObjects,
+                                std::map<art::Ptr<T>, HitVector>& matchedHits);
+
     /**
      *  @brief Select reconstructed neutrino particles from a list of all reconstructed particles
      *
@@ -617,6 +805,18 @@ namespace lar_pandora {
       const PFParticleMap& particleMap,
       const art::Ptr<recob::PFParticle> daughterParticle);
 
+    /**
+     *  @brief Return the top-level parent particle from a precomputed particle hierarchy
+     *
+     *  @param particleHierarchy the precomputed hierarchy of reconstructed particles
+     *  @param daughterParticle the input PF particle
+     *
+     *  @return the top-level parent particle
+     */
+    static art::Ptr<recob::PFParticle> GetParentPFParticle(
+      const PFParticleHierarchy& particleHierarchy,
+      const art::Ptr<recob::PFParticle> daughterParticle);
+
     /**
      *  @brief Return the final-state parent particle by navigating up the chain of parent/daughter associations
      *
@@ -629,6 +829,18 @@ namespace lar_pandora {
       const PFParticleMap& particleMap,
       const art::Ptr<recob::PFParticle> daughterParticle);
 
+    /**
+     *  @brief Return the final-state parent particle from a precomputed particle hierarchy
+     *
+     *  @param particleHierarchy the precomputed hierarchy of reconstructed particles
+     *  @param daughterParticle the input PF particle
+     *
+     *  @return the final-state parent particle
+     */
+    static art::Ptr<recob::PFParticle> GetFinalStatePFParticle(
+      const PFParticleHierarchy& particleHierarchy,
+      const art::Ptr<recob::PFParticle> daughterParticle);
+
     /**
      *  @brief Return the top-level parent particle by navigating up the chain of parent/daughter associations
      *
@@ -673,6 +885,17 @@ namespace lar_pandora {
     static int GetGeneration(const PFParticleMap& particleMap,
                              const art::Ptr<recob::PFParticle> daughterParticle);
 
+    /**
+     *  @brief Return the generation of this particle (first generation if primary)
+     *
+     *  @param particleHierarchy the precomputed hierarchy of reconstructed particles
+     *  @param daughterParticle the input daughter particle
+     *
+     *  @return the nth generation in the particle hierarchy
+     */
+    static int GetGeneration(const PFParticleHierarchy& particleHierarchy,
+                             const art::Ptr<recob::PFParticle> daughterParticle);
+
     /**
      *  @brief Return the parent neutrino PDG code (or zero for cosmics) for a given reconstructed particle
      *
@@ -684,6 +907,17 @@ namespace lar_pandora {
     static int GetParentNeutrino(const PFParticleMap& particleMap,
                                  const art::Ptr<recob::PFParticle> daughterParticle);
 
+    /**
+     *  @brief Return the parent neutrino PDG code (or zero for cosmics) for a given reconstructed particle
+     *
+     *  @param particleHierarchy the precomputed hierarchy of reconstructed particles
+     *  @param daughterParticle the input daughter particle
+     *
+     *  @return the PDG code of the parent neutrinos (or zero for cosmics)
+     */
+    static int GetParentNeutrino(const PFParticleHierarchy& particleHierarchy,
+                                 const art::Ptr<recob::PFParticle> daughterParticle);
+
     /**
      *  @brief Determine whether a particle has been reconstructed as a final-state particle
      *
@@ -695,6 +929,17 @@ namespace lar_pandora {
     static bool IsFinalState(const PFParticleMap& particleMap,
                              const art::Ptr<recob::PFParticle> daughterParticle);
 
+    /**
+     *  @brief Determine whether a particle has been reconstructed as a final-state particle
+     *
+     *  @param particleHierarchy the precomputed hierarchy of reconstructed particles
+     *  @param daughterParticle the input daughter particle
+     *
+     *  @return true/false
+     */
+    static bool IsFinalState(const PFParticleHierarchy& particleHierarchy,
+                             const art::Ptr<recob::PFParticle> daughterParticle);
+
     /**
      *  @brief Determine whether a particle has been reconstructed as a neutrino
      *
@@ -740,6 +985,641 @@ namespace lar_pandora {
      */
     static larpandoraobj::PFParticleMetadata GetPFParticleMetadata(
       const pandora::ParticleFlowObject* const pPfo);
+
+  private:
+    /**
+     *  @brief Add the mapping between a hit and the true particle contributing most of its energy
+     *
+     *  @param hit the input hit
+     *  @param trackIDEBegin the start of the true energy deposits of the hit
+     *  @param trackIDEEnd the end of the true energy deposits of the hit
+     *  @param particleMap the mapping between true particles and true track IDs
+     *  @param particlesToHits the mapping between true particles and reconstructed hits
+     *  @param hitsToParticles the mapping between reconstructed hits and true particles
+     *  @param daughterMode treatment of daughter particles in construction of maps
+     */
+    static void AddMCParticleHitMatch(const art::Ptr<recob::Hit>& hit,
+                                      const TrackIDEVector::const_iterator trackIDEBegin,
+                                      const TrackIDEVector::const_iterator trackIDEEnd,
+                                      const MCParticleMap& particleMap,
+                                      MCParticlesToHits& particlesToHits,
+                                      HitsToMCParticles& hitsToParticles,
+                                      const DaughterMode daughterMode);
+  };
+
+  /**
+ *  @brief  HitTrackIDEIndex class, flat mapping from hits to their true energy deposits
+ */
+  class HitTrackIDEIndex {
+  public:
+    /**
+     *  @brief  Get the number of hits in the index
+     *
+     *  @return the number of hits
+     */
+    size_t GetNHits() const;
+
+    /**
+     *  @brief  Get a hit in the index
+     *
+     *  @param  hitIndex the index of the hit, i.e. its key in the input hit collection
+     *
+     *  @return the hit
+     */
+    const art::Ptr<recob::Hit>& GetHit(const size_t hitIndex) const;
+
+    /**
+     *  @brief  Get the start of the contiguous range of true energy deposits for a hit
+     *
+     *  @param  hitIndex the index of the hit
+     *
+     *  @return iterator to the first true energy deposit of the hit
+     */
+    TrackIDEVector::const_iterator TrackIDEsBegin(const size_t hitIndex) const;
+
+    /**
+     *  @brief  Get the end of the contiguous range of true energy deposits for a hit
+     *
+     *  @param  hitIndex the index of the hit
+     *
+     *  @return iterator past the last true energy deposit of the hit
+     */
+    TrackIDEVector::const_iterator TrackIDEsEnd(const size_t hitIndex) const;
+
+    /**
+     *  @brief  Fill the map based description of the index, as produced by LArPandoraHelper::BuildMCParticleHitMaps
+     *
+     *  @param  hitsToTrackIDEs the output map between hits and true energy deposits
+     */
+    void FillMap(HitsToTrackIDEs& hitsToTrackIDEs) const;
+
+  private:
+    friend class LArPandoraHelper;
+
+    HitVector m_hits; ///< The hits, indexed by their key in the input collection
+    std::vector<size_t>
+      m_trackIDEOffsets; ///< The offset of the first true energy deposit of each hit, followed by the total number of deposits
+    TrackIDEVector m_trackIDEs; ///< The true energy deposits of all of the hits, contiguous for each hit
+  };
+
+  /**
+ *  @brief  PFParticleHitIndex class, compressed sparse row mapping between PFParticles and Hits
+ */
+  class PFParticleHitIndex {
+  public:
+    /**
+     *  @brief  Get the number of particles in the index
+     *
+     *  @return the number of particles
+     */
+    size_t GetNParticles() const;
+
+    /**
+     *  @brief  Get a particle in the index
+     *
+     *  @param  particleIndex the index of the particle, i.e. its key in the input PFParticle collection
+     *
+     *  @return the particle
+     */
+    const art::Ptr<recob::PFParticle>& GetParticle(const size_t particleIndex) const;
+
+    /**
+     *  @brief  Get the start of the contiguous range of hits for a particle
+     *
+     *  @param  particleIndex the index of the particle
+     *
+     *  @return iterator to the first hit of the particle
+     */
+    HitVector::const_iterator HitsBegin(const size_t particleIndex) const;
+
+    /**
+     *  @brief  Get the end of the contiguous range of hits for a particle
+     *
+     *  @param  particleIndex the index of the particle
+     *
+     *  @return iterator past the last hit of the particle
+     */
+    HitVector::const_iterator HitsEnd(const size_t particleIndex) const;
+
+    /**
+     *  @brief  Get the index of the particle containing a hit (the last one, if a hit is shared)
+     *
+     *  @param  hit the input hit
+     *  @param  particleIndex the output index of the particle
+     *
+     *  @return whether the hit is contained in a particle
+     */
+    bool GetParticleIndex(const art::Ptr<recob::Hit>& hit, size_t& particleIndex) const;
+
+    /**
+     *  @brief  Fill the map based description of the index, as produced by LArPandoraHelper::BuildPFParticleHitMaps
+     *
+     *  @param  particlesToHits the output map from PFParticle to Hit objects
+     *  @param  hitsToParticles the output map from Hit to PFParticle objects
+     */
+    void FillMaps(PFParticlesToHits& particlesToHits, HitsToPFParticles& hitsToParticles) const;
+
+  private:
+    friend class LArPandoraHelper;
+
+    PFParticleVector m_particles; ///< The particles, indexed by their key in the input collection
+    std::vector<size_t>
+      m_hitOffsets; ///< The offset of the first hit of each particle in the hit vector, followed by the total number of hits
+    HitVector m_hits; ///< The hits of all of the particles, contiguous for each particle
+    std::vector<art::ProductID> m_hitProductIds; ///< The product IDs of the input hit collections
+    std::vector<std::vector<size_t>>
+      m_hitKeyToParticleIndices; ///< For each hit collection, the index of the particle containing each hit key
+  };
+
+  /**
+ *  @brief  PFParticleProductLoader class, reading the PFParticle products and their associations from the ART event record
+ *
+ *  The products and associations are declared up front; each product handle is then fetched once per event and all of the
+ *  requested association views are filled in a single sweep over the product.
+ */
+  class PFParticleProductLoader {
+  public:
+    /**
+     *  @brief  The products that can be requested from the loader, in addition to the PFParticles
+     */
+    enum Product : unsigned int {
+      kClusters = 0x01,    ///< The PFParticle to Cluster associations, and the Clusters with their Hits
+      kSpacePoints = 0x02, ///< The PFParticle to SpacePoint associations, and the SpacePoints with their Hits
+      kVertices = 0x04,    ///< The Vertices with their PFParticle associations
+      kT0s = 0x08,         ///< The T0s with their PFParticle associations
+      kTracks = 0x10,      ///< The Tracks with their PFParticle and Hit associations
+      kShowers = 0x20      ///< The Showers with their PFParticle and Hit associations
+    };
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  particleLabel the label for the PFParticle list and its associations (also used for Vertices and T0s)
+     *  @param  clusterLabel the label for the Cluster list and its Hit associations
+     *  @param  spacePointLabel the label for the SpacePoint list and its Hit associations
+     *  @param  trackLabel the label for the Track list and its associations
+     *  @param  showerLabel the label for the Shower list and its associations
+     *  @param  products the requested products, a combination of the Product flags
+     */
+    PFParticleProductLoader(const std::string& particleLabel,
+                            const std::string& clusterLabel,
+                            const std::string& spacePointLabel,
+                            const std::string& trackLabel,
+                            const std::string& showerLabel,
+                            const unsigned int products);
+
+    /**
+     *  @brief  Read the requested products from the ART event record, replacing those of any previous event
+     *
+     *  @param  evt the ART event record
+     */
+    void Load(const art::Event& evt);
+
+    /**
+     *  @brief  Build mapping between PFParticles and Hits from the loaded products, as LArPandoraHelper::BuildPFParticleHitMaps
+     *
+     *  @param  particlesToHits the output map from PFParticle to Hit objects
+     *  @param  hitsToParticles the output map from Hit to PFParticle objects
+     *  @param  daughterMode treatment of daughter particles in construction of maps
+     *  @param  useClusters choice of intermediate object (true for Clusters, false for SpacePoints)
+     */
+    void BuildPFParticleHitMaps(PFParticlesToHits& particlesToHits,
+                                HitsToPFParticles& hitsToParticles,
+                                const LArPandoraHelper::DaughterMode daughterMode =
+                                  LArPandoraHelper::kUseDaughters,
+                                const bool useClusters = true) const;
+
+    /**
+     *  @brief  Get the loaded PFParticles
+     *
+     *  @return the PFParticles
+     */
+    const PFParticleVector& GetPFParticles() const { return m_particleVector; }
+
+    /**
+     *  @brief  Get the mapping from PFParticle to Cluster objects, empty unless kClusters was requested
+     *
+     *  @return the mapping from PFParticle to Cluster objects
+     */
+    const PFParticlesToClusters& GetPFParticlesToClusters() const { return m_particlesToClusters; }
+
+    /**
+     *  @brief  Get the loaded Clusters, empty unless kClusters was requested
+     *
+     *  @return the Clusters
+     */
+    const ClusterVector& GetClusters() const { return m_clusterVector; }
+
+    /**
+     *  @brief  Get the mapping from Cluster to Hit objects, empty unless kClusters was requested
+     *
+     *  @return the mapping from Cluster to Hit objects
+     */
+    const ClustersToHits& GetClustersToHits() const { return m_clustersToHits; }
+
+    /**
+     *  @brief  Get the mapping from PFParticle to SpacePoint objects, empty unless kSpacePoints was requested
+     *
+     *  @return the mapping from PFParticle to SpacePoint objects
+     */
+    const PFParticlesToSpacePoints& GetPFParticlesToSpacePoints() const
+    {
+      return m_particlesToSpacePoints;
+    }
+
+    /**
+     *  @brief  Get the loaded SpacePoints, empty unless kSpacePoints was requested
+     *
+     *  @return the SpacePoints
+     */
+    const SpacePointVector& GetSpacePoints() const { return m_spacePointVector; }
+
+    /**
+     *  @brief  Get the mapping from SpacePoint to Hit objects, empty unless kSpacePoints was requested
+     *
+     *  @return the mapping from SpacePoint to Hit objects
+     */
+    const SpacePointsToHits& GetSpacePointsToHits() const { return m_spacePointsToHits; }
+
+    /**
+     *  @brief  Get the loaded Vertices, empty unless kVertices was requested
+     *
+     *  @return the Vertices
+     */
+    const VertexVector& GetVertices() const { return m_vertexVector; }
+
+    /**
+     *  @brief  Get the mapping from PFParticle to Vertex objects, empty unless kVertices was requested
+     *
+     *  @return the mapping from PFParticle to Vertex objects
+     */
+    const PFParticlesToVertices& GetPFParticlesToVertices() const { return m_particlesToVertices; }
+
+    /**
+     *  @brief  Get the loaded T0s, empty unless kT0s was requested
+     *
+     *  @return the T0s
+     */
+    const T0Vector& GetT0s() const { return m_t0Vector; }
+
+    /**
+     *  @brief  Get the mapping from PFParticle to T0 objects, empty unless kT0s was requested
+     *
+     *  @return the mapping from PFParticle to T0 objects
+     */
+    const PFParticlesToT0s& GetPFParticlesToT0s() const { return m_particlesToT0s; }
+
+    /**
+     *  @brief  Get the loaded Tracks, empty unless kTracks was requested
+     *
+     *  @return the Tracks
+     */
+    const TrackVector& GetTracks() const { return m_trackVector; }
+
+    /**
+     *  @brief  Get the mapping from PFParticle to Track objects, empty unless kTracks was requested
+     *
+     *  @return the mapping from PFParticle to Track objects
+     */
+    const PFParticlesToTracks& GetPFParticlesToTracks() const { return m_particlesToTracks; }
+
+    /**
+     *  @brief  Get the mapping from Track to Hit objects, empty unless kTracks was requested
+     *
+     *  @return the mapping from Track to Hit objects
+     */
+    const TracksToHits& GetTracksToHits() const { return m_tracksToHits; }
+
+    /**
+     *  @brief  Get the loaded Showers, empty unless kShowers was requested
+     *
+     *  @return the Showers
+     */
+    const ShowerVector& GetShowers() const { return m_showerVector; }
+
+    /**
+     *  @brief  Get the mapping from PFParticle to Shower objects, empty unless kShowers was requested
+     *
+     *  @return the mapping from PFParticle to Shower objects
+     */
+    const PFParticlesToShowers& GetPFParticlesToShowers() const { return m_particlesToShowers; }
+
+    /**
+     *  @brief  Get the mapping from Shower to Hit objects, empty unless kShowers was requested
+     *
+     *  @return the mapping from Shower to Hit objects
+     */
+    const ShowersToHits& GetShowersToHits() const { return m_showersToHits; }
+
+  private:
+    /**
+     *  @brief  Check that a product has been requested, throwing otherwise
+     *
+     *  @param  product the product
+     *  @param  functionName the name of the calling function, for the exception message
+     */
+    void CheckRequested(const Product product, const std::string& functionName) const;
+
+    void LoadPFParticles(const art::Event& evt);
+    void LoadClusters(const art::Event& evt);
+    void LoadSpacePoints(const art::Event& evt);
+    void LoadVertices(const art::Event& evt);
+    void LoadT0s(const art::Event& evt);
+    void LoadTracks(const art::Event& evt);
+    void LoadShowers(const art::Event& evt);
+
+    const std::string m_particleLabel;   ///< The label for the PFParticle list and its associations
+    const std::string m_clusterLabel;    ///< The label for the Cluster list and its Hit associations
+    const std::string m_spacePointLabel; ///< The label for the SpacePoint list and its Hit associations
+    const std::string m_trackLabel;      ///< The label for the Track list and its associations
+    const std::string m_showerLabel;     ///< The label for the Shower list and its associations
+    const unsigned int m_products;       ///< The requested products
+
+    PFParticleVector m_particleVector;                 ///< The PFParticles
+    PFParticlesToClusters m_particlesToClusters;       ///< The map from PFParticle to Clusters
+    ClusterVector m_clusterVector;                     ///< The Clusters
+    ClustersToHits m_clustersToHits;                   ///< The map from Cluster to Hits
+    PFParticlesToSpacePoints m_particlesToSpacePoints; ///< The map from PFParticle to SpacePoints
+    SpacePointVector m_spacePointVector;               ///< The SpacePoints
+    SpacePointsToHits m_spacePointsToHits;             ///< The map from SpacePoint to Hit
+    VertexVector m_vertexVector;                       ///< The Vertices
+    PFParticlesToVertices m_particlesToVertices;       ///< The map from PFParticle to Vertices
+    T0Vector m_t0Vector;                               ///< The T0s
+    PFParticlesToT0s m_particlesToT0s;                 ///< The map from PFParticle to T0s
+    TrackVector m_trackVector;                         ///< The Tracks
+    PFParticlesToTracks m_particlesToTracks;           ///< The map from PFParticle to Tracks
+    TracksToHits m_tracksToHits;                       ///< The map from Track to Hits
+    ShowerVector m_showerVector;                       ///< The Showers
+    PFParticlesToShowers m_particlesToShowers;         ///< The map from PFParticle to Showers
+    ShowersToHits m_showersToHits;                     ///< The map from Shower to Hits
+  };
+
+  /**
+ *  @brief  TrackTrajectoryArrays class, the points of a track trajectory extracted in a single pass into contiguous arrays
+ *
+ *  Filling the arrays for successive trajectories reuses their storage, so no allocation is needed once the longest
+ *  trajectory has been seen.
+ */
+  class TrackTrajectoryArrays {
+  public:
+    /**
+     *  @brief  Default constructor
+     */
+    TrackTrajectoryArrays();
+
+    /**
+     *  @brief  Extract the points of a trajectory, replacing those of any previous trajectory
+     *
+     *  @param  trajectory the input track trajectory
+     */
+    void Fill(const recob::TrackTrajectory& trajectory);
+
+    /**
+     *  @brief  Get the number of trajectory points, including the invalid ones
+     *
+     *  @return the number of trajectory points
+     */
+    size_t GetNPoints() const { return m_isValid.size(); }
+
+    /**
+     *  @brief  Get the x position of each trajectory point
+     *
+     *  @return the x positions
+     */
+    const std::vector<double>& GetX() const { return m_x; }
+
+    /**
+     *  @brief  Get the y position of each trajectory point
+     *
+     *  @return the y positions
+     */
+    const std::vector<double>& GetY() const { return m_y; }
+
+    /**
+     *  @brief  Get the z position of each trajectory point
+     *
+     *  @return the z positions
+     */
+    const std::vector<double>& GetZ() const { return m_z; }
+
+    /**
+     *  @brief  Get the x component of the direction at each trajectory point
+     *
+     *  @return the x direction components
+     */
+    const std::vector<double>& GetDirectionX() const { return m_directionX; }
+
+    /**
+     *  @brief  Get the y component of the direction at each trajectory point
+     *
+     *  @return the y direction components
+     */
+    const std::vector<double>& GetDirectionY() const { return m_directionY; }
+
+    /**
+     *  @brief  Get the z component of the direction at each trajectory point
+     *
+     *  @return the z direction components
+     */
+    const std::vector<double>& GetDirectionZ() const { return m_directionZ; }
+
+    /**
+     *  @brief  Get whether each trajectory point is valid, as recob::TrackTrajectory::HasValidPoint
+     *
+     *  @return the validity flags, non-zero for valid points
+     */
+    const std::vector<char>& GetIsValid() const { return m_isValid; }
+
+    /**
+     *  @brief  Get the residual range at each trajectory point, as recob::TrackTrajectory::Length(point)
+     *
+     *  @return the residual ranges, where an invalid point takes that of the next valid point
+     */
+    const std::vector<double>& GetResidualRange() const { return m_residualRange; }
+
+    /**
+     *  @brief  Get the length of the trajectory, as recob::TrackTrajectory::Length()
+     *
+     *  @return the length
+     */
+    double GetLength() const { return (m_residualRange.empty() ? 0.0 : m_residualRange.front()); }
+
+    /**
+     *  @brief  Get the number of valid trajectory points
+     *
+     *  @return the number of valid trajectory points
+     */
+    size_t GetNValidPoints() const { return m_nValidPoints; }
+
+    /**
+     *  @brief  Get the minimum x position of the valid trajectory points (only meaningful if there are valid points)
+     *
+     *  @return the minimum x position
+     */
+    double GetMinX() const { return m_minX; }
+
+    /**
+     *  @brief  Get the maximum x position of the valid trajectory points (only meaningful if there are valid points)
+     *
+     *  @return the maximum x position
+     */
+    double GetMaxX() const { return m_maxX; }
+
+    /**
+     *  @brief  Get the minimum y position of the valid trajectory points (only meaningful if there are valid points)
+     *
+     *  @return the minimum y position
+     */
+    double GetMinY() const { return m_minY; }
+
+    /**
+     *  @brief  Get the maximum y position of the valid trajectory points (only meaningful if there are valid points)
+     *
+     *  @return the maximum y position
+     */
+    double GetMaxY() const { return m_maxY; }
+
+    /**
+     *  @brief  Get the minimum z position of the valid trajectory points (only meaningful if there are valid points)
+     *
+     *  @return the minimum z position
+     */
+    double GetMinZ() const { return m_minZ; }
+
+    /**
+     *  @brief  Get the maximum z position of the valid trajectory points (only meaningful if there are valid points)
+     *
+     *  @return the maximum z position
+     */
+    double GetMaxZ() const { return m_maxZ; }
+
+  private:
+    std::vector<double> m_x;             ///< The x position of each point
+    std::vector<double> m_y;             ///< The y position of each point
+    std::vector<double> m_z;             ///< The z position of each point
+    std::vector<double> m_directionX;    ///< The x component of the direction at each point
+    std::vector<double> m_directionY;    ///< The y component of the direction at each point
+    std::vector<double> m_directionZ;    ///< The z component of the direction at each point
+    std::vector<char> m_isValid;         ///< Whether each point is valid
+    std::vector<double> m_residualRange; ///< The length from each point to the end of the trajectory
+    size_t m_nValidPoints;               ///< The number of valid points
+    double m_minX;                       ///< The minimum x position of the valid points
+    double m_maxX;                       ///< The maximum x position of the valid points
+    double m_minY;                       ///< The minimum y position of the valid points
+    double m_maxY;                       ///< The maximum y position of the valid points
+    double m_minZ;                       ///< The minimum z position of the valid points
+    double m_maxZ;                       ///< The maximum z position of the valid points
+  };
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  /**
+ *  @brief  HitCountWeight class, the weighting for RecoTrueOverlapTable in which each hit counts once
+ */
+  class HitCountWeight {
+  public:
+    typedef unsigned int WeightType;
+
+    WeightType operator()(const size_t) const { return 1; }
+  };
+
+  /**
+ *  @brief  HitChargeWeight class, the weighting for RecoTrueOverlapTable in which each hit counts its integrated charge
+ */
+  class HitChargeWeight {
+  public:
+    typedef float WeightType;
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  hits the hits, in the ordering of their indices
+     */
+    HitChargeWeight(const HitVector& hits);
+
+    WeightType operator()(const size_t hitIndex) const { return m_charges[hitIndex]; }
+
+  private:
+    std::vector<float> m_charges; ///< The integrated charge of each hit
+  };
+
+  /**
+ *  @brief  RecoTrueOverlapTable class, the weight of the hits shared between each reconstructed object and each true object
+ *
+ *  Hits are referred to by dense indices (see LArPandoraHelper::BuildRecoTrueHitIndices), each carrying the index of its
+ *  true object. The overlaps of a reconstructed object are accumulated in a single pass over its hit indices into a dense
+ *  per-true-object array, so no maps are consulted per hit. Purities and completenesses follow from the overlaps and the
+ *  total weights of the reconstructed and true objects.
+ */
+  template <typename WeightPolicy = HitCountWeight>
+  class RecoTrueOverlapTable {
+  public:
+    typedef typename WeightPolicy::WeightType WeightType;
+    typedef std::pair<size_t, WeightType> TrueIndexAndWeight;
+    typedef std::vector<TrueIndexAndWeight> OverlapVector;
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  hitsToTrueIndex the index of the true object of each hit (or LArPandoraHelper::kNoTrueIndex)
+     *  @param  nTrueObjects the number of true objects
+     *  @param  weightPolicy the weighting of each hit
+     */
+    RecoTrueOverlapTable(const std::vector<size_t>& hitsToTrueIndex,
+                         const size_t nTrueObjects,
+                         const WeightPolicy& weightPolicy = WeightPolicy());
+
+    /**
+     *  @brief  Add a reconstructed object to the table, computing its overlaps with the true objects
+     *
+     *  @param  recoHitIndices the indices of the hits of the reconstructed object
+     *
+     *  @return the index of the reconstructed object in the table
+     */
+    size_t AddRecoObject(const std::vector<size_t>& recoHitIndices);
+
+    /**
+     *  @brief  Get the overlaps of a reconstructed object with the true objects it shares hits with
+     *
+     *  @param  recoIndex the index of the reconstructed object
+     *
+     *  @return the overlaps, in order of increasing true index
+     */
+    const OverlapVector& GetOverlaps(const size_t recoIndex) const { return m_overlaps.at(recoIndex); }
+
+    size_t GetNRecoObjects() const { return m_overlaps.size(); }
+    size_t GetNTrueObjects() const { return m_trueWeights.size(); }
+    WeightType GetRecoWeight(const size_t recoIndex) const { return m_recoWeights.at(recoIndex); }
+    WeightType GetTrueWeight(const size_t trueIndex) const { return m_trueWeights.at(trueIndex); }
+
+    /**
+     *  @brief  Get the purity of a reconstructed object with respect to one of its overlapping true objects
+     *
+     *  @param  recoIndex the index of the reconstructed object
+     *  @param  overlap the overlap of the reconstructed object with the true object
+     *
+     *  @return the purity
+     */
+    float GetPurity(const size_t recoIndex, const TrueIndexAndWeight& overlap) const;
+
+    /**
+     *  @brief  Get the completeness of a true object with respect to one of its overlapping reconstructed objects
+     *
+     *  @param  overlap the overlap of the reconstructed object with the true object
+     *
+     *  @return the completeness
+     */
+    float GetCompleteness(const TrueIndexAndWeight& overlap) const;
+
+  private:
+    std::vector<size_t> m_hitsToTrueIndex;    ///< The index of the true object of each hit
+    WeightPolicy m_weightPolicy;              ///< The weighting of each hit
+    std::vector<WeightType> m_trueWeights;    ///< The total weight of the hits of each true object
+    std::vector<WeightType> m_recoWeights;    ///< The total weight of the hits of each reconstructed object
+    std::vector<OverlapVector> m_overlaps;    ///< The overlaps of each reconstructed object
+    std::vector<WeightType> m_sharedWeights;  ///< Accumulator for the overlaps of the current reconstructed object
+    std::vector<char> m_isShared;             ///< Whether each true object overlaps the current reconstructed object
+    std::vector<size_t> m_sharedTrueIndices;  ///< The true objects overlapping the current reconstructed object
   };
 
 } // namespace lar_pandora
@@ -28,13 +28,15 @@
 
 #include "larpandoracontent/LArControlFlow/MultiPandoraApi.h"
 #include "larpandoracontent/LArHelpers/LArClusterHelper.h"
+#include "larpandoracontent/LArHelpers/LArPcaHelper.h"
 #include "larpandoracontent/LArHelpers/LArPfoHelper.h"
 
 #include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <iterator>
 #include <limits>
-#include <numeric> // std::iota()
+#include <unordered_map>
 
 namespace lar_pandora {
 
@@ -394,6 +396,7 @@ namespace lar_pandora {
     std::function<const pandora::Vertex* const(const pandora::ParticleFlowObject* const)> fCriteria)
   {
     pandora::VertexVector vertexVector;
+    std::unordered_map<const pandora::Vertex*, size_t> vertexToIdMap;
 
     for (unsigned int pfoId = 0; pfoId < pfoVector.size(); ++pfoId) {
       const pandora::ParticleFlowObject* const pPfo(pfoVector.at(pfoId));
@@ -404,12 +407,10 @@ namespace lar_pandora {
         const pandora::Vertex* const pVertex(fCriteria(pPfo));
 
         // Get the vertex ID and add it to the vertex list if required
-        const auto it(std::find(vertexVector.begin(), vertexVector.end(), pVertex));
-        const bool isInList(it != vertexVector.end());
-        const size_t vertexId(isInList ? std::distance(vertexVector.begin(), it) :
-                                         vertexVector.size());
+        const auto insertion(vertexToIdMap.emplace(pVertex, vertexVector.size()));
+        const size_t vertexId(insertion.first->second);
 
-        if (!isInList) vertexVector.push_back(pVertex);
+        if (insertion.second) vertexVector.push_back(pVertex);
 
         if (!pfoToVerticesMap.insert(IdToIdVectorMap::value_type(pfoId, {vertexId})).second)
           throw cet::exception("LArPandora")
@@ -429,6 +430,7 @@ namespace lar_pandora {
                                                          IdToIdVectorMap& pfoToClustersMap)
   {
     pandora::ClusterList clusterList;
+    std::unordered_map<const pandora::Cluster*, size_t> clusterToIdMap;
 
     for (unsigned int pfoId = 0; pfoId < pfoVector.size(); ++pfoId) {
       const pandora::ParticleFlowObject* const pPfo(pfoVector.at(pfoId));
@@ -438,11 +440,15 @@ namespace lar_pandora {
       lar_content::LArPfoHelper::GetTwoDClusterList(pPfo, clusters);
       clusters.sort(lar_content::LArClusterHelper::SortByNHits);
 
-      // Get incrementing id's for each cluster
-      IdVector clusterIds(clusters.size());
-      std::iota(clusterIds.begin(), clusterIds.end(), clusterList.size());
+      // Get incrementing id's for each new cluster, and reuse the id of any cluster already collected
+      IdVector clusterIds;
+      clusterIds.reserve(clusters.size());
+      for (const pandora::Cluster* const pCluster : clusters) {
+        const auto insertion(clusterToIdMap.emplace(pCluster, clusterList.size()));
+        clusterIds.push_back(insertion.first->second);
 
-      clusterList.insert(clusterList.end(), clusters.begin(), clusters.end());
+        if (insertion.second) clusterList.push_back(pCluster);
+      }
 
       if (!pfoToClustersMap.insert(IdToIdVectorMap::value_type(pfoId, clusterIds)).second)
         throw cet::exception("LArPandora")
@@ -494,7 +500,45 @@ namespace lar_pandora {
     lar_content::LArPfoHelper::GetCaloHits(pPfo, pandora::TPC_3D, threeDHits);
 
     caloHits.insert(caloHits.end(), threeDHits.begin(), threeDHits.end());
-    std::sort(caloHits.begin(), caloHits.end(), lar_content::LArClusterHelper::SortHitsByPosition);
+    LArPandoraOutput::SortHitsByPosition(caloHits);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  void LArPandoraOutput::SortHitsByPosition(pandora::CaloHitVector& caloHits)
+  {
+    struct SortKey {
+      float m_z;                          ///< The hit z position
+      float m_x;                          ///< The hit x position
+      float m_y;                          ///< The hit y position
+      const pandora::CaloHit* m_pCaloHit; ///< The address of the hit
+    };
+
+    std::vector<SortKey> sortKeys;
+    sortKeys.reserve(caloHits.size());
+    for (const pandora::CaloHit* const pCaloHit : caloHits) {
+      const pandora::CartesianVector& position(pCaloHit->GetPositionVector());
+      sortKeys.push_back({position.GetZ(), position.GetX(), position.GetY(), pCaloHit});
+    }
+
+    // ATTN this mirrors the comparisons in LArClusterHelper::SortHitsByPosition, so std::sort yields the same permutation.
+    //      Hits at the same position are passed to the original function, which then applies its own tie-break
+    const float epsilon(std::numeric_limits<float>::epsilon());
+    std::sort(sortKeys.begin(), sortKeys.end(), [epsilon](const SortKey& lhs, const SortKey& rhs) {
+      const float deltaZ(rhs.m_z - lhs.m_z);
+      if (std::fabs(deltaZ) > epsilon) return (deltaZ > epsilon);
+
+      const float deltaX(rhs.m_x - lhs.m_x);
+      if (std::fabs(deltaX) > epsilon) return (deltaX > epsilon);
+
+      const float deltaY(rhs.m_y - lhs.m_y);
+      if (std::fabs(deltaY) > epsilon) return (deltaY > epsilon);
+
+      return lar_content::LArClusterHelper::SortHitsByPosition(lhs.m_pCaloHit, rhs.m_pCaloHit);
+    });
+
+    for (size_t i = 0; i < sortKeys.size(); ++i)
+      caloHits[i] = sortKeys[i].m_pCaloHit;
   }
 
   //------------------------------------------------------------------------------------------------------------------------------------------
@@ -628,14 +672,14 @@ namespace lar_pandora {
     util::GeometryUtilities const gser{*geom, clock_data, det_prop};
 
     // Produce the art clusters
-    size_t nextClusterId(0);
+    size_t nextClusterId(0), pandoraClusterId(0);
     IdToIdVectorMap pandoraClusterToArtClustersMap;
     for (const pandora::Cluster* const pCluster : clusterList) {
       std::vector<HitVector> hitVectors;
       const std::vector<recob::Cluster> clusters(
         LArPandoraOutput::BuildClusters(gser,
                                         pCluster,
-                                        clusterList,
+                                        pandoraClusterId++,
                                         pandoraHitToArtHitMap,
                                         pandoraClusterToArtClustersMap,
                                         hitVectors,
@@ -773,12 +817,9 @@ namespace lar_pandora {
     pandora::PfoVector slicePfos;
     LArPandoraOutput::GetPandoraSlices(pPrimaryPandora, slicePfos);
 
-    // Make one slice per Pandora Slice pfo
-    for (const pandora::ParticleFlowObject* const pSlicePfo : slicePfos)
-      LArPandoraOutput::BuildSlice(
-        pSlicePfo, event, instanceLabel, idToHitMap, outputSlices, outputSlicesToHits);
-
-    // Make a slice for every remaining pfo hierarchy that wasn't already in a slice
+    // Make one slice per Pandora Slice pfo, then a slice for every remaining pfo hierarchy that wasn't already in a slice
+    const unsigned int firstSliceIndex(outputSlices->size());
+    pandora::PfoVector sliceParentPfos(slicePfos);
     std::unordered_map<const pandora::ParticleFlowObject*, unsigned int> parentPfoToSliceIndexMap;
     for (unsigned int pfoId = 0; pfoId < pfoVector.size(); ++pfoId) {
       const pandora::ParticleFlowObject* const pPfo(pfoVector.at(pfoId));
@@ -788,13 +829,23 @@ namespace lar_pandora {
 
       if (lar_content::LArPfoHelper::GetParentPfo(pPfo) != pPfo) continue;
 
-      if (!parentPfoToSliceIndexMap
-             .emplace(pPfo,
-                      LArPandoraOutput::BuildSlice(
-                        pPfo, event, instanceLabel, idToHitMap, outputSlices, outputSlicesToHits))
-             .second)
+      if (!parentPfoToSliceIndexMap.emplace(pPfo, firstSliceIndex + sliceParentPfos.size()).second)
         throw cet::exception("LArPandora")
           << " LArPandoraOutput::BuildSlices --- found repeated primary particles ";
+
+      sliceParentPfos.push_back(pPfo);
+    }
+
+    outputSlices->reserve(firstSliceIndex + sliceParentPfos.size());
+    for (unsigned int i = 0; i < sliceParentPfos.size(); ++i) {
+      recob::Slice slice;
+      HitVector sliceHits;
+      LArPandoraOutput::BuildSlice(
+        sliceParentPfos[i], firstSliceIndex + i, idToHitMap, slice, sliceHits);
+
+      outputSlices->push_back(std::move(slice));
+      LArPandoraOutput::AddAssociation(
+        event, instanceLabel, firstSliceIndex + i, sliceHits, outputSlicesToHits);
     }
 
     // Add the associations from PFOs to slices
@@ -826,18 +877,76 @@ namespace lar_pandora {
 
   //------------------------------------------------------------------------------------------------------------------------------------------
 
-  unsigned int LArPandoraOutput::BuildDummySlice(SliceCollection& outputSlices)
+  recob::Slice LArPandoraOutput::BuildDummySlice(const unsigned int sliceIndex, const float charge)
   {
-    // Make a slice with dummy properties
+    // Make a slice with dummy geometry properties
     const float bogusFloat(std::numeric_limits<float>::max());
     const recob::tracking::Point_t bogusPoint(bogusFloat, bogusFloat, bogusFloat);
     const recob::tracking::Vector_t bogusVector(bogusFloat, bogusFloat, bogusFloat);
 
-    const unsigned int sliceIndex(outputSlices->size());
-    outputSlices->emplace_back(
-      sliceIndex, bogusPoint, bogusVector, bogusPoint, bogusPoint, bogusFloat, bogusFloat);
+    return recob::Slice(
+      sliceIndex, bogusPoint, bogusVector, bogusPoint, bogusPoint, bogusFloat, charge);
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  float LArPandoraOutput::GetSliceCharge(const HitVector& sliceHits)
+  {
+    // ATTN only the collection plane hits are summed, to avoid counting the same charge in each view
+    float charge(0.f);
+    for (const art::Ptr<recob::Hit>& hit : sliceHits) {
+      if (geo::kCollection == hit->SignalType()) charge += hit->Integral();
+    }
+
+    return charge;
+  }
+
+  //------------------------------------------------------------------------------------------------------------------------------------------
+
+  recob::Slice LArPandoraOutput::BuildSliceWithGeometry(const unsigned int sliceIndex,
+                                                        const pandora::CaloHitList& threeDHits,
+                                                        const float charge)
+  {
+    if (threeDHits.size() < 2) return LArPandoraOutput::BuildDummySlice(sliceIndex, charge);
+
+    pandora::CartesianVector centroid(0.f, 0.f, 0.f);
+    lar_content::LArPcaHelper::EigenValues eigenValues(0.f, 0.f, 0.f);
+    lar_content::LArPcaHelper::EigenVectors eigenVectors;
+
+    try {
+      lar_content::LArPcaHelper::RunPca(threeDHits, centroid, eigenValues, eigenVectors);
+    }
+    catch (const pandora::StatusCodeException&) {
+      return LArPandoraOutput::BuildDummySlice(sliceIndex, charge);
+    }
+
+    const pandora::CartesianVector& primaryAxis(eigenVectors.front());
 
-    return sliceIndex;
+    // Find the extent of the hits along the primary axis
+    float minProjection(std::numeric_limits<float>::max());
+    float maxProjection(-std::numeric_limits<float>::max());
+    for (const pandora::CaloHit* const pCaloHit : threeDHits) {
+      const float projection(primaryAxis.GetDotProduct(pCaloHit->GetPositionVector() - centroid));
+      minProjection = std::min(minProjection, projection);
+      maxProjection = std::max(maxProjection, projection);
+    }
+
+    const pandora::CartesianVector end0(centroid + primaryAxis * minProjection);
+    const pandora::CartesianVector end1(centroid + primaryAxis * maxProjection);
+
+    // ATTN the aspect ratio is the ratio of the width of the slice to its length
+    const float aspectRatio(eigenValues.GetX() > std::numeric_limits<float>::epsilon() ?
+                              std::sqrt(std::max(0.f, eigenValues.GetY()) / eigenValues.GetX()) :
+                              0.f);
+
+    return recob::Slice(
+      sliceIndex,
+      recob::tracking::Point_t(centroid.GetX(), centroid.GetY(), centroid.GetZ()),
+      recob::tracking::Vector_t(primaryAxis.GetX(), primaryAxis.GetY(), primaryAxis.GetZ()),
+      recob::tracking::Point_t(end0.GetX(), end0.GetY(), end0.GetZ()),
+      recob::tracking::Point_t(end1.GetX(), end1.GetY(), end1.GetZ()),
+      aspectRatio,
+      charge);
   }
 
   //------------------------------------------------------------------------------------------------------------------------------------------
@@ -852,11 +961,20 @@ namespace lar_pandora {
     PFParticleToSliceCollection& outputParticlesToSlices,
     SliceToHitCollection& outputSlicesToHits)
   {
-    const unsigned int sliceIndex(LArPandoraOutput::BuildDummySlice(outputSlices));
-
     // Add all of the hits in the events to the slice
     HitVector hits;
     LArPandoraHelper::CollectHits(event, settings.m_hitfinderModuleLabel, hits);
+
+    const float charge(LArPandoraOutput::GetSliceCharge(hits));
+
+    // Describe the slice geometry using the 3D hits of all of the PFOs
+    pandora::CaloHitList threeDHits;
+    for (const pandora::ParticleFlowObject* const pPfo : pfoVector)
+      lar_content::LArPfoHelper::GetCaloHits(pPfo, pandora::TPC_3D, threeDHits);
+
+    const unsigned int sliceIndex(outputSlices->size());
+    outputSlices->push_back(
+      LArPandoraOutput::BuildSliceWithGeometry(sliceIndex, threeDHits, charge));
     LArPandoraOutput::AddAssociation(event, instanceLabel, sliceIndex, hits, outputSlicesToHits);
 
     mf::LogDebug("LArPandora") << "Finding hits with label: " << settings.m_hitfinderModuleLabel
@@ -873,39 +991,38 @@ namespace lar_pandora {
 
   //------------------------------------------------------------------------------------------------------------------------------------------
 
-  unsigned int LArPandoraOutput::BuildSlice(const pandora::ParticleFlowObject* const pParentPfo,
-                                            const art::Event& event,
-                                            const std::string& instanceLabel,
-                                            const IdToHitMap& idToHitMap,
-                                            SliceCollection& outputSlices,
-                                            SliceToHitCollection& outputSlicesToHits)
+  void LArPandoraOutput::BuildSlice(const pandora::ParticleFlowObject* const pParentPfo,
+                                    const unsigned int sliceIndex,
+                                    const IdToHitMap& idToHitMap,
+                                    recob::Slice& slice,
+                                    HitVector& sliceHits)
   {
-    const unsigned int sliceIndex(LArPandoraOutput::BuildDummySlice(outputSlices));
-
     // Collect the pfos connected to the input primary pfos
+    // ATTN no need to sort the pfos here, as the order of the hits associated to the slice isn't meaningful
     pandora::PfoList pfosInSlice;
     lar_content::LArPfoHelper::GetAllConnectedPfos(pParentPfo, pfosInSlice);
-    pfosInSlice.sort(lar_content::LArPfoHelper::SortByNHits);
 
-    // Collect the hits from the pfos in all views
-    pandora::CaloHitList hits;
+    // Collect the hits from the pfos in all views, and the 3D hits that describe the slice geometry
+    pandora::CaloHitList hits, threeDHits;
     for (const pandora::ParticleFlowObject* const pPfo : pfosInSlice) {
       for (const pandora::HitType& hitType :
            {pandora::TPC_VIEW_U, pandora::TPC_VIEW_V, pandora::TPC_VIEW_W}) {
         lar_content::LArPfoHelper::GetCaloHits(pPfo, hitType, hits);
         lar_content::LArPfoHelper::GetIsolatedCaloHits(pPfo, hitType, hits);
       }
+
+      lar_content::LArPfoHelper::GetCaloHits(pPfo, pandora::TPC_3D, threeDHits);
     }
 
-    // Add the associations to the hits
+    // Collect the art hits to associate to the slice in one go
+    HitVector hitsInSlice;
+    hitsInSlice.reserve(hits.size());
     for (const pandora::CaloHit* const pCaloHit : hits)
-      LArPandoraOutput::AddAssociation(event,
-                                       instanceLabel,
-                                       sliceIndex,
-                                       {LArPandoraOutput::GetHit(idToHitMap, pCaloHit)},
-                                       outputSlicesToHits);
+      hitsInSlice.push_back(LArPandoraOutput::GetHit(idToHitMap, pCaloHit));
 
-    return sliceIndex;
+    slice = LArPandoraOutput::BuildSliceWithGeometry(
+      sliceIndex, threeDHits, LArPandoraOutput::GetSliceCharge(hitsInSlice));
+    sliceHits.insert(sliceHits.end(), hitsInSlice.begin(), hitsInSlice.end());
   }
 
   //------------------------------------------------------------------------------------------------------------------------------------------
@@ -916,15 +1033,36 @@ namespace lar_pandora {
                                   T0Collection& outputT0s,
                                   PFParticleToT0Collection& outputParticlesToT0s)
   {
+    // The conversion factors are the same for every pfo in the event
+    auto const clock_data =
+      art::ServiceHandle<detinfo::DetectorClocksService const>()->DataFor(event);
+    auto const det_prop =
+      art::ServiceHandle<detinfo::DetectorPropertiesService const>()->DataFor(event, clock_data);
+    const double cm_per_tick(det_prop.GetXTicksCoefficient());
+    const double ns_per_tick(sampling_rate(clock_data));
+
+    const art::PtrMaker<recob::PFParticle> makePfoPtr(event, instanceLabel);
+    const art::PtrMaker<anab::T0> makeT0Ptr(event, instanceLabel);
+
+    // ATTN the T0 only depends on the top-level parent, so calculate it once per hierarchy
+    std::unordered_map<const pandora::ParticleFlowObject*, double> parentToT0Map;
+
     size_t nextT0Id(0);
     for (unsigned int pfoId = 0; pfoId < pfoVector.size(); ++pfoId) {
-      const pandora::ParticleFlowObject* const pPfo(pfoVector.at(pfoId));
+      const pandora::ParticleFlowObject* const pParent(
+        lar_content::LArPfoHelper::GetParentPfo(pfoVector.at(pfoId)));
+
+      auto parentIt(parentToT0Map.find(pParent));
+      if (parentIt == parentToT0Map.end())
+        parentIt = parentToT0Map
+                     .emplace(pParent,
+                              LArPandoraOutput::GetHierarchyT0(pParent, ns_per_tick, cm_per_tick))
+                     .first;
 
       anab::T0 t0;
-      if (!LArPandoraOutput::BuildT0(event, pPfo, pfoVector, nextT0Id, t0)) continue;
+      if (!LArPandoraOutput::BuildT0(parentIt->second, pfoId, nextT0Id, t0)) continue;
 
-      LArPandoraOutput::AddAssociation(
-        event, instanceLabel, pfoId, nextT0Id - 1, outputParticlesToT0s);
+      outputParticlesToT0s->addSingle(makePfoPtr(pfoId), makeT0Ptr(nextT0Id - 1));
       outputT0s->push_back(t0);
     }
   }
@@ -981,8 +1119,7 @@ namespace lar_pandora {
                    pCluster->GetIsolatedCaloHitList().end());
 
     sortedHits.insert(sortedHits.end(), hitList.begin(), hitList.end());
-    std::sort(
-      sortedHits.begin(), sortedHits.end(), lar_content::LArClusterHelper::SortHitsByPosition);
+    LArPandoraOutput::SortHitsByPosition(sortedHits);
   }
 
   //------------------------------------------------------------------------------------------------------------------------------------------
@@ -990,7 +1127,7 @@ namespace lar_pandora {
   std::vector<recob::Cluster> LArPandoraOutput::BuildClusters(
     util::GeometryUtilities const& gser,
     const pandora::Cluster* const pCluster,
-    const pandora::ClusterList& clusterList,
+    const size_t clusterId,
     const CaloHitToArtHitMap& pandoraHitToArtHitMap,
     IdToIdVectorMap& pandoraClusterToArtClustersMap,
     std::vector<HitVector>& hitVectors,
@@ -999,8 +1136,7 @@ namespace lar_pandora {
   {
     std::vector<recob::Cluster> clusters;
 
-    // Get the cluster ID and set up the map entry
-    const size_t clusterId(LArPandoraOutput::GetId(pCluster, clusterList));
+    // Set up the map entry for the cluster ID
     if (!pandoraClusterToArtClustersMap.insert(IdToIdVectorMap::value_type(clusterId, {})).second)
       throw cet::exception("LArPandora")
         << " LArPandoraOutput::BuildClusters --- repeated clusters in input list ";
@@ -1148,29 +1284,30 @@ namespace lar_pandora {
 
   //------------------------------------------------------------------------------------------------------------------------------------------
 
-  bool LArPandoraOutput::BuildT0(const art::Event& e,
-                                 const pandora::ParticleFlowObject* const pPfo,
-                                 const pandora::PfoVector& pfoVector,
-                                 size_t& nextId,
-                                 anab::T0& t0)
+  double LArPandoraOutput::GetHierarchyT0(const pandora::ParticleFlowObject* const pParentPfo,
+                                           const double nsPerTick,
+                                           const double cmPerTick)
   {
-    const pandora::ParticleFlowObject* const pParent(lar_content::LArPfoHelper::GetParentPfo(pPfo));
-    const float x0(pParent->GetPropertiesMap().count("X0") ? pParent->GetPropertiesMap().at("X0") :
-                                                             0.f);
+    const auto& properties(pParentPfo->GetPropertiesMap());
+    const auto it(properties.find("X0"));
+    const float x0(it != properties.end() ? it->second : 0.f);
 
-    auto const clock_data = art::ServiceHandle<detinfo::DetectorClocksService const>()->DataFor(e);
-    auto const det_prop =
-      art::ServiceHandle<detinfo::DetectorPropertiesService const>()->DataFor(e, clock_data);
-    const double cm_per_tick(det_prop.GetXTicksCoefficient());
-    const double ns_per_tick(sampling_rate(clock_data));
+    // ATTN: T0 values are currently calculated in nanoseconds relative to the trigger offset.
+    return x0 * nsPerTick / cmPerTick;
+  }
 
-    // ATTN: T0 values are currently calculated in nanoseconds relative to the trigger offset. Only non-zero values are outputted.
-    const double T0(x0 * ns_per_tick / cm_per_tick);
+  //------------------------------------------------------------------------------------------------------------------------------------------
 
-    if (std::fabs(T0) <= std::numeric_limits<double>::epsilon()) return false;
+  bool LArPandoraOutput::BuildT0(const double hierarchyT0,
+                                 const size_t pfoId,
+                                 size_t& nextId,
+                                 anab::T0& t0)
+  {
+    // ATTN: Only non-zero values are outputted.
+    if (std::fabs(hierarchyT0) <= std::numeric_limits<double>::epsilon()) return false;
 
     // Output T0 objects [arguments are:  time (nanoseconds);  trigger type (3 for TPC stitching!);  pfparticle SelfID code;  T0 ID code]
-    t0 = anab::T0(T0, 3, LArPandoraOutput::GetId(pPfo, pfoVector), nextId++);
+    t0 = anab::T0(hierarchyT0, 3, pfoId, nextId++);
 
     return true;
   }
@@ -228,6 +228,14 @@ namespace lar_pandora {
     static void Collect3DHits(const pandora::ParticleFlowObject* const pPfo,
                               pandora::CaloHitVector& caloHits);
 
+    /**
+     *  @brief  Sort a vector of hits by position, giving exactly the same order as lar_content::LArClusterHelper::SortHitsByPosition
+     *          The hit positions are cached up front, so the comparisons don't have to dereference and subtract position vectors
+     *
+     *  @param  caloHits the vector of hits to sort
+     */
+    static void SortHitsByPosition(pandora::CaloHitVector& caloHits);
+
     /**
      *  @brief  Collect a sorted list of all 3D hits contained in the input pfo list
      *          Order is guaranteed provided pfoVector is ordered
@@ -411,11 +419,38 @@ namespace lar_pandora {
                             SliceToHitCollection& outputSlicesToHits);
 
     /**
-     *  @brief  Build a new slice object with dummy information
+     *  @brief  Build a new slice object with dummy geometry information
      *
-     *  @param  outputSlices the output collection of slices to populate
+     *  @param  sliceIndex the index of the new slice
+     *  @param  charge the total charge of the slice
+     *
+     *  @return the new slice
+     */
+    static recob::Slice BuildDummySlice(const unsigned int sliceIndex, const float charge);
+
+    /**
+     *  @brief  Get the charge of a slice, defined as the sum of the integrals of its collection plane hits
+     *
+     *  @param  sliceHits the ART hits in the slice
+     *
+     *  @return the total charge of the slice
+     */
+    static float GetSliceCharge(const HitVector& sliceHits);
+
+    /**
+     *  @brief  Build a new slice object, with its centre, direction, end points and aspect ratio from a principal component
+     *          analysis of the input 3D hits. If this isn't possible, a slice with dummy geometry information is built
+     *          instead, which still carries the input charge.
+     *
+     *  @param  sliceIndex the index of the new slice
+     *  @param  threeDHits the input list of 3D hits in the slice
+     *  @param  charge the total charge of the slice
+     *
+     *  @return the new slice
      */
-    static unsigned int BuildDummySlice(SliceCollection& outputSlices);
+    static recob::Slice BuildSliceWithGeometry(const unsigned int sliceIndex,
+                                               const pandora::CaloHitList& threeDHits,
+                                               const float charge);
 
     /**
      *  @brief  Ouput a single slice containing all of the input hits
@@ -442,18 +477,16 @@ namespace lar_pandora {
      *  @brief  Build a new slice object from a PFO, this can be a top-level parent in a hierarchy or a "slice PFO" from the slicing instance
      *
      *  @param  pParentPfo the parent pfo from which to build the slice
-     *  @param  event the art event
-     *  @param  instanceLabel the label for the collections to be produced
+     *  @param  sliceIndex the index of the new slice
      *  @param  idToHitMap input mapping from pandora hit ID to ART hit
-     *  @param  outputSlices the output collection of slices to populate
-     *  @param  outputSlicesToHits the output association from slices to hits
+     *  @param  slice the output slice
+     *  @param  sliceHits the output vector of ART hits to associate to the slice
      */
-    static unsigned int BuildSlice(const pandora::ParticleFlowObject* const pParentPfo,
-                                   const art::Event& event,
-                                   const std::string& instanceLabel,
-                                   const IdToHitMap& idToHitMap,
-                                   SliceCollection& outputSlices,
-                                   SliceToHitCollection& outputSlicesToHits);
+    static void BuildSlice(const pandora::ParticleFlowObject* const pParentPfo,
+                           const unsigned int sliceIndex,
+                           const IdToHitMap& idToHitMap,
+                           recob::Slice& slice,
+                           HitVector& sliceHits);
 
     /**
      *  @brief  Calculate the T0 of each pfos and add them to the output vector
@@ -505,7 +538,7 @@ namespace lar_pandora {
      *  @brief  Convert from a pandora 2D cluster to a vector of ART clusters (produce multiple if the cluster is split over drift volumes)
      *
      *  @param  pCluster the input cluster
-     *  @param  clusterList the input list of clusters
+     *  @param  clusterId the ID of the input cluster in the list of clusters being output
      *  @param  pandoraHitToArtHitMap the input mapping from pandora hits to ART hits
      *  @param  pandoraClusterToArtClustersMap output mapping from pandora cluster ID to art cluster IDs
      *  @param  hitVectors the output vectors of hits for each cluster produced used to produce associations
@@ -516,7 +549,7 @@ namespace lar_pandora {
     static std::vector<recob::Cluster> BuildClusters(
       util::GeometryUtilities const& gser,
       const pandora::Cluster* const pCluster,
-      const pandora::ClusterList& clusterList,
+      const size_t clusterId,
       const CaloHitToArtHitMap& pandoraHitToArtHitMap,
       IdToIdVectorMap& pandoraClusterToArtClustersMap,
       std::vector<HitVector>& hitVectors,
@@ -555,22 +588,30 @@ namespace lar_pandora {
                                              const size_t pfoId,
                                              const pandora::PfoVector& pfoVector);
 
+    /**
+     *  @brief  Calculate the T0 shared by all pfos in a hierarchy, from the stitching hit shift distance of its parent
+     *
+     *  @param  pParentPfo the top-level parent pfo of the hierarchy
+     *  @param  nsPerTick the sampling rate, in nanoseconds per tick
+     *  @param  cmPerTick the drift distance per tick, in centimetres
+     *
+     *  @return the T0 in nanoseconds relative to the trigger offset
+     */
+    static double GetHierarchyT0(const pandora::ParticleFlowObject* const pParentPfo,
+                                 const double nsPerTick,
+                                 const double cmPerTick);
+
     /**
      *  @brief  If required, build a T0 for the input pfo
      *
-     *  @param  event the ART event
-     *  @param  pPfo the input pfo
-     *  @param  pfoVector the input list of pfos
+     *  @param  hierarchyT0 the T0 of the hierarchy containing the pfo
+     *  @param  pfoId the id of the input pfo
      *  @param  nextId the ID of the T0 - will be incremented if the t0 was produced
      *  @param  t0 the output T0
      *
-     *  @return if a T0 was produced (calculated from the stitching hit shift distance)
+     *  @return if a T0 was produced (i.e. the hierarchy T0 is non-zero)
      */
-    static bool BuildT0(const art::Event& event,
-                        const pandora::ParticleFlowObject* const pPfo,
-                        const pandora::PfoVector& pfoVector,
-                        size_t& nextId,
-                        anab::T0& t0);
+    static bool BuildT0(const double hierarchyT0, const size_t pfoId, size_t& nextId, anab::T0& t0);
 
     /**
      *  @brief  Add an association between objects with two given ids
@@ -0,0 +1,371 @@
+/**
+ *  @file   test/LArPandoraEventBuilding/LArPandoraEvent_test.cc
+ *
+ *  @brief  Unit test of the association writing in LArPandoraEvent, against a search through the written collections
+ */
+
+#define BOOST_TEST_MODULE (LArPandoraEvent_test)
+#include "boost/test/unit_test.hpp"
+
+#include "larpandora/LArPandoraEventBuilding/LArPandoraEvent.h"
+
+#include "canvas/Persistency/Provenance/ProductID.h"
+#include "cetlib_except/exception.h"
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <utility>
+
+namespace lar_pandora {
+
+  /**
+   *  @brief  Gives the test access to the private association helpers of LArPandoraEvent
+   */
+  class LArPandoraEventTestAccess {
+  public:
+    template <typename... Args>
+    static void BuildIndexMap(Args&&... args)
+    {
+      LArPandoraEvent::BuildIndexMap(std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    static size_t GetIndex(Args&&... args)
+    {
+      return LArPandoraEvent::GetIndex(std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    static void FillAssociation(Args&&... args)
+    {
+      LArPandoraEvent::FillAssociation(std::forward<Args>(args)...);
+    }
+  };
+
+} // namespace lar_pandora
+
+using lar_pandora::LArPandoraEvent;
+using lar_pandora::LArPandoraEventTestAccess;
+
+namespace {
+
+  // The collections read from the input producers (e.g. Pandora pat-rec), the hits, and the copies written by this producer
+  const art::ProductID inputID(1);
+  const art::ProductID hitID(2);
+  const art::ProductID outputID(3);
+
+  /**
+   *  @brief  Stands in for art::PtrMaker, making the art::Ptrs to the copies written by this producer
+   */
+  template <typename T>
+  class TestPtrMaker {
+  public:
+    art::Ptr<T> operator()(const size_t index) const { return art::Ptr<T>(outputID, index, nullptr); }
+  };
+
+  /**
+   *  @brief  Make a synthetic collection with the keys shuffled, so that the index of an object is not its key, and with an object repeated
+   */
+  template <typename T>
+  LArPandoraEvent::Collection<T> MakeCollection(const art::ProductID& productID,
+                                                const size_t nObjects,
+                                                std::mt19937& generator)
+  {
+    std::vector<size_t> keys(nObjects);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), generator);
+
+    LArPandoraEvent::Collection<T> collection;
+    for (const size_t key : keys)
+      collection.emplace_back(productID, key, nullptr);
+
+    collection.push_back(collection.at(nObjects / 2));
+    return collection;
+  }
+
+  /**
+   *  @brief  Make a synthetic association from each object in collectionL to a random selection of the objects in collectionR
+   */
+  template <typename L, typename R, typename D, typename MakeD>
+  LArPandoraEvent::Association<L, R, D> MakeAssociation(
+    const LArPandoraEvent::Collection<L>& collectionL,
+    const LArPandoraEvent::Collection<R>& collectionR,
+    const MakeD& makeD,
+    std::mt19937& generator)
+  {
+    std::uniform_int_distribution<size_t> nEntries(0, 5);
+    std::uniform_int_distribution<size_t> entry(0, collectionR.size() - 1);
+
+    LArPandoraEvent::Association<L, R, D> association;
+    for (const auto& objectL : collectionL) {
+      auto& entries(association[objectL]);
+      for (size_t n = nEntries(generator); entries.size() < n;)
+        entries.emplace_back(collectionR.at(entry(generator)), makeD(entries.size()));
+    }
+
+    return association;
+  }
+
+  /**
+   *  @brief  The reference index lookup, a search through the written collection
+   */
+  template <typename T>
+  size_t FindIndex(const art::Ptr<T>& object, const LArPandoraEvent::Collection<T>& collection)
+  {
+    const auto it(std::find(collection.begin(), collection.end(), object));
+    if (it == collection.end())
+      throw cet::exception("LArPandora")
+        << " FindIndex -- Can't find input object in the supplied collection." << std::endl;
+
+    return std::distance(collection.begin(), it);
+  }
+
+  /**
+   *  @brief  The reference association writing with metadata, searching through the written collections
+   */
+  template <typename L, typename R, typename D>
+  void FillReferenceAssociation(const LArPandoraEvent::Association<L, R, D>& associationMap,
+                                const LArPandoraEvent::Collection<L>& collectionL,
+                                const LArPandoraEvent::Collection<R>& collectionR,
+                                const bool thisProducesR,
+                                art::Assns<L, R, D>& outputAssn)
+  {
+    const TestPtrMaker<L> makePtrL;
+    const TestPtrMaker<R> makePtrR;
+
+    for (auto it = associationMap.begin(); it != associationMap.end(); ++it) {
+      const auto outputPtrL(makePtrL(FindIndex(it->first, collectionL)));
+
+      for (const auto& entry : it->second) {
+        if (thisProducesR)
+          outputAssn.addSingle(
+            outputPtrL, makePtrR(FindIndex(entry.first, collectionR)), entry.second);
+        else
+          outputAssn.addSingle(outputPtrL, entry.first, entry.second);
+      }
+    }
+  }
+
+  /**
+   *  @brief  The reference association writing without metadata, searching through the written collections
+   */
+  template <typename L, typename R>
+  void FillReferenceAssociation(const LArPandoraEvent::Association<L, R, void*>& associationMap,
+                                const LArPandoraEvent::Collection<L>& collectionL,
+                                const LArPandoraEvent::Collection<R>& collectionR,
+                                const bool thisProducesR,
+                                art::Assns<L, R>& outputAssn)
+  {
+    const TestPtrMaker<L> makePtrL;
+    const TestPtrMaker<R> makePtrR;
+
+    for (auto it = associationMap.begin(); it != associationMap.end(); ++it) {
+      const auto outputPtrL(makePtrL(FindIndex(it->first, collectionL)));
+
+      for (const auto& entry : it->second) {
+        if (thisProducesR)
+          outputAssn.addSingle(outputPtrL, makePtrR(FindIndex(entry.first, collectionR)));
+        else
+          outputAssn.addSingle(outputPtrL, entry.first);
+      }
+    }
+  }
+
+  /**
+   *  @brief  Check two associations hold the same pairs of art::Ptrs in the same order
+   */
+  template <typename L, typename R, typename D>
+  void CheckSamePtrs(const art::Assns<L, R, D>& assn, const art::Assns<L, R, D>& reference)
+  {
+    BOOST_TEST_REQUIRE(assn.size() == reference.size());
+
+    for (size_t i = 0; i < assn.size(); ++i) {
+      BOOST_CHECK(assn[i].first == reference[i].first);
+      BOOST_CHECK(assn[i].second == reference[i].second);
+    }
+  }
+
+  /**
+   *  @brief  Check two associations with track hit metadata hold the same pairs of art::Ptrs and metadata in the same order
+   */
+  template <typename L, typename R>
+  void CheckSame(const art::Assns<L, R, recob::TrackHitMeta>& assn,
+                 const art::Assns<L, R, recob::TrackHitMeta>& reference)
+  {
+    CheckSamePtrs(assn, reference);
+
+    for (size_t i = 0; i < assn.size(); ++i) {
+      BOOST_TEST(assn.data(i).Index() == reference.data(i).Index());
+      BOOST_TEST(assn.data(i).Dx() == reference.data(i).Dx());
+    }
+  }
+
+  const auto makeTrackHitMeta = [](const size_t i) { return recob::TrackHitMeta(i, 0.3 * i); };
+  const auto makeNoMetadata = [](const size_t) { return static_cast<void*>(nullptr); };
+
+} // namespace
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(IndexMap_matches_collection_search)
+{
+  std::mt19937 generator(53);
+  const auto pfParticles(MakeCollection<recob::PFParticle>(inputID, 100, generator));
+
+  LArPandoraEvent::IndexMap<recob::PFParticle> pfParticleIndices;
+  LArPandoraEventTestAccess::BuildIndexMap(pfParticles, pfParticleIndices);
+
+  // The repeated object maps to its first occurrence, as a search through the collection finds
+  BOOST_TEST(pfParticleIndices.size() == pfParticles.size() - 1);
+
+  for (const auto& pfParticle : pfParticles)
+    BOOST_TEST(LArPandoraEventTestAccess::GetIndex(pfParticle, pfParticleIndices) ==
+               FindIndex(pfParticle, pfParticles));
+
+  // Objects from another product, or beyond the collection, are not found
+  const art::Ptr<recob::PFParticle> otherProduct(outputID, 0, nullptr);
+  const art::Ptr<recob::PFParticle> beyondCollection(inputID, 100, nullptr);
+  BOOST_CHECK_THROW(LArPandoraEventTestAccess::GetIndex(otherProduct, pfParticleIndices), cet::exception);
+  BOOST_CHECK_THROW(LArPandoraEventTestAccess::GetIndex(beyondCollection, pfParticleIndices),
+                    cet::exception);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Association_both_collections_written)
+{
+  std::mt19937 generator(530);
+  const auto pfParticles(MakeCollection<recob::PFParticle>(inputID, 60, generator));
+  const auto clusters(MakeCollection<recob::Cluster>(inputID, 200, generator));
+  const auto tracks(MakeCollection<recob::Track>(inputID, 40, generator));
+
+  LArPandoraEvent::IndexMap<recob::PFParticle> pfParticleIndices;
+  LArPandoraEvent::IndexMap<recob::Cluster> clusterIndices;
+  LArPandoraEvent::IndexMap<recob::Track> trackIndices;
+  LArPandoraEventTestAccess::BuildIndexMap(pfParticles, pfParticleIndices);
+  LArPandoraEventTestAccess::BuildIndexMap(clusters, clusterIndices);
+  LArPandoraEventTestAccess::BuildIndexMap(tracks, trackIndices);
+
+  const TestPtrMaker<recob::PFParticle> makePFParticlePtr;
+  const TestPtrMaker<recob::Cluster> makeClusterPtr;
+  const TestPtrMaker<recob::Track> makeTrackPtr;
+
+  // Without metadata
+  const auto pfParticleClusterMap(
+    MakeAssociation<recob::PFParticle, recob::Cluster, void*>(
+      pfParticles, clusters, makeNoMetadata, generator));
+
+  art::Assns<recob::PFParticle, recob::Cluster> pfParticleClusterAssn, pfParticleClusterReference;
+  LArPandoraEventTestAccess::FillAssociation(pfParticleClusterMap,
+                                   pfParticleIndices,
+                                   clusterIndices,
+                                   makePFParticlePtr,
+                                   makeClusterPtr,
+                                   pfParticleClusterAssn);
+  FillReferenceAssociation(
+    pfParticleClusterMap, pfParticles, clusters, true, pfParticleClusterReference);
+
+  BOOST_TEST(pfParticleClusterAssn.size() > 0u);
+  CheckSamePtrs(pfParticleClusterAssn, pfParticleClusterReference);
+
+  // With metadata
+  const auto pfParticleTrackMap(
+    MakeAssociation<recob::PFParticle, recob::Track, recob::TrackHitMeta>(
+      pfParticles, tracks, makeTrackHitMeta, generator));
+
+  art::Assns<recob::PFParticle, recob::Track, recob::TrackHitMeta> pfParticleTrackAssn,
+    pfParticleTrackReference;
+  LArPandoraEventTestAccess::FillAssociation(pfParticleTrackMap,
+                                   pfParticleIndices,
+                                   trackIndices,
+                                   makePFParticlePtr,
+                                   makeTrackPtr,
+                                   pfParticleTrackAssn);
+  FillReferenceAssociation(
+    pfParticleTrackMap, pfParticles, tracks, true, pfParticleTrackReference);
+
+  BOOST_TEST(pfParticleTrackAssn.size() > 0u);
+  CheckSame(pfParticleTrackAssn, pfParticleTrackReference);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Association_to_objects_from_another_module)
+{
+  std::mt19937 generator(5300);
+  const auto clusters(MakeCollection<recob::Cluster>(inputID, 80, generator));
+  const auto tracks(MakeCollection<recob::Track>(inputID, 30, generator));
+  const auto hits(MakeCollection<recob::Hit>(hitID, 500, generator));
+
+  LArPandoraEvent::IndexMap<recob::Cluster> clusterIndices;
+  LArPandoraEvent::IndexMap<recob::Track> trackIndices;
+  LArPandoraEventTestAccess::BuildIndexMap(clusters, clusterIndices);
+  LArPandoraEventTestAccess::BuildIndexMap(tracks, trackIndices);
+
+  // Without metadata
+  const auto clusterHitMap(MakeAssociation<recob::Cluster, recob::Hit, void*>(
+    clusters, hits, makeNoMetadata, generator));
+
+  art::Assns<recob::Cluster, recob::Hit> clusterHitAssn, clusterHitReference;
+  LArPandoraEventTestAccess::FillAssociation(
+    clusterHitMap, clusterIndices, TestPtrMaker<recob::Cluster>(), clusterHitAssn);
+  FillReferenceAssociation(clusterHitMap, clusters, hits, false, clusterHitReference);
+
+  BOOST_TEST(clusterHitAssn.size() > 0u);
+  CheckSamePtrs(clusterHitAssn, clusterHitReference);
+
+  // The hits keep their original art::Ptrs
+  for (size_t i = 0; i < clusterHitAssn.size(); ++i)
+    BOOST_CHECK(clusterHitAssn[i].second.id() == hitID);
+
+  // With metadata
+  const auto trackHitMap(MakeAssociation<recob::Track, recob::Hit, recob::TrackHitMeta>(
+    tracks, hits, makeTrackHitMeta, generator));
+
+  art::Assns<recob::Track, recob::Hit, recob::TrackHitMeta> trackHitAssn, trackHitReference;
+  LArPandoraEventTestAccess::FillAssociation(
+    trackHitMap, trackIndices, TestPtrMaker<recob::Track>(), trackHitAssn);
+  FillReferenceAssociation(trackHitMap, tracks, hits, false, trackHitReference);
+
+  BOOST_TEST(trackHitAssn.size() > 0u);
+  CheckSame(trackHitAssn, trackHitReference);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Association_with_unwritten_object_throws)
+{
+  std::mt19937 generator(53000);
+  const auto pfParticles(MakeCollection<recob::PFParticle>(inputID, 10, generator));
+  const auto clusters(MakeCollection<recob::Cluster>(inputID, 10, generator));
+
+  LArPandoraEvent::IndexMap<recob::PFParticle> pfParticleIndices;
+  LArPandoraEvent::IndexMap<recob::Cluster> clusterIndices;
+  LArPandoraEventTestAccess::BuildIndexMap(pfParticles, pfParticleIndices);
+  LArPandoraEventTestAccess::BuildIndexMap(clusters, clusterIndices);
+
+  // A cluster that is not in the written collection
+  LArPandoraEvent::Association<recob::PFParticle, recob::Cluster, void*> pfParticleClusterMap;
+  pfParticleClusterMap[pfParticles.front()].emplace_back(
+    art::Ptr<recob::Cluster>(inputID, 10, nullptr), nullptr);
+
+  art::Assns<recob::PFParticle, recob::Cluster> pfParticleClusterAssn;
+  BOOST_CHECK_THROW(LArPandoraEventTestAccess::FillAssociation(pfParticleClusterMap,
+                                                     pfParticleIndices,
+                                                     clusterIndices,
+                                                     TestPtrMaker<recob::PFParticle>(),
+                                                     TestPtrMaker<recob::Cluster>(),
+                                                     pfParticleClusterAssn),
+                    cet::exception);
+
+  // A cluster, on the left of the association, that is not in the written collection
+  LArPandoraEvent::Association<recob::Cluster, recob::Hit, void*> clusterHitMap;
+  clusterHitMap[art::Ptr<recob::Cluster>(outputID, 0, nullptr)];
+
+  art::Assns<recob::Cluster, recob::Hit> clusterHitAssn;
+  BOOST_CHECK_THROW(LArPandoraEventTestAccess::FillAssociation(
+                      clusterHitMap, clusterIndices, TestPtrMaker<recob::Cluster>(), clusterHitAssn),
+                    cet::exception);
+}
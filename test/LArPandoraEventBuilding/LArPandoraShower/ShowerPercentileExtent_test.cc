@@ -0,0 +1,226 @@
+/**
+ *  @file   test/LArPandoraEventBuilding/LArPandoraShower/ShowerPercentileExtent_test.cc
+ *
+ *  @brief  Unit test of the shower percentile length and width, against the ordering of the spacepoints in maps
+ */
+
+#define BOOST_TEST_MODULE (ShowerPercentileExtent_test)
+#include "boost/test/unit_test.hpp"
+
+#include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Algs/ShowerPercentileExtent.h"
+
+#include "cetlib_except/exception.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <random>
+#include <vector>
+
+using shower::ShowerPercentileExtent;
+
+namespace {
+
+  /**
+   *  @brief  A spacepoint position, or a shower direction
+   */
+  struct Point {
+    double m_x;
+    double m_y;
+    double m_z;
+  };
+
+  /**
+   *  @brief  The projection of a point along the direction from the start, as LArPandoraShowerAlg::SpacePointProjection
+   */
+  double Projection(const Point& point, const Point& start, const Point& direction)
+  {
+    return (point.m_x - start.m_x) * direction.m_x + (point.m_y - start.m_y) * direction.m_y +
+           (point.m_z - start.m_z) * direction.m_z;
+  }
+
+  /**
+   *  @brief  The distance of a point from the axis, as LArPandoraShowerAlg::SpacePointPerpendicular
+   */
+  double Perpendicular(const Point& point, const Point& start, const Point& direction)
+  {
+    const double projection(Projection(point, start, direction));
+    const double x(point.m_x - start.m_x - projection * direction.m_x);
+    const double y(point.m_y - start.m_y - projection * direction.m_y);
+    const double z(point.m_z - start.m_z - projection * direction.m_z);
+    return std::sqrt(x * x + y * y + z * z);
+  }
+
+  /**
+   *  @brief  The percentile length, maximum projection and width before ShowerPercentileExtent, from the points ordered in
+   *          maps as by LArPandoraShowerAlg::OrderShowerSpacePoints and OrderShowerSpacePointsPerpendicular
+   */
+  std::vector<double> ReferenceExtent(const std::vector<Point>& points,
+                                      const Point& start,
+                                      const Point& direction,
+                                      const float percentile)
+  {
+    std::map<double, Point> projectionOrdered;
+    for (const Point& point : points)
+      projectionOrdered[Projection(point, start, direction)] = point;
+
+    std::vector<Point> ordered;
+    for (const auto& entry : projectionOrdered)
+      ordered.push_back(entry.second);
+
+    const int lengthIter = percentile * ordered.size();
+    const double length(Projection(ordered[lengthIter], start, direction));
+    const double maxProjection(Projection(ordered.back(), start, direction));
+
+    std::map<double, Point> perpendicularOrdered;
+    for (const Point& point : ordered)
+      perpendicularOrdered[Perpendicular(point, start, direction)] = point;
+
+    ordered.clear();
+    for (const auto& entry : perpendicularOrdered)
+      ordered.push_back(entry.second);
+
+    const int perpIter = percentile * ordered.size();
+    const double width(Perpendicular(ordered[perpIter], start, direction));
+
+    return {length, maxProjection, width};
+  }
+
+  /**
+   *  @brief  Get the bits of a double, so that the comparisons distinguish -0 from +0
+   */
+  std::uint64_t Bits(const double value)
+  {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+
+  /**
+   *  @brief  Check that ShowerPercentileExtent gives bit identical results to the map orderings
+   */
+  void CheckExtent(const std::vector<Point>& points,
+                   const Point& start,
+                   const Point& direction,
+                   const float percentile)
+  {
+    std::vector<double> projections, perpendiculars;
+    for (const Point& point : points) {
+      projections.push_back(Projection(point, start, direction));
+      perpendiculars.push_back(Perpendicular(point, start, direction));
+    }
+
+    const ShowerPercentileExtent extent(projections, perpendiculars, percentile);
+    const std::vector<double> reference(ReferenceExtent(points, start, direction, percentile));
+
+    BOOST_TEST(Bits(extent.Length()) == Bits(reference.at(0)));
+    BOOST_TEST(Bits(extent.MaxProjection()) == Bits(reference.at(1)));
+    BOOST_TEST(Bits(extent.Width()) == Bits(reference.at(2)));
+  }
+
+  /**
+   *  @brief  Make points on an integer grid, so that many projections and perpendicular distances are equal, and repeat
+   *          some of them exactly
+   */
+  std::vector<Point> MakeGridPoints(const size_t nPoints, std::mt19937& generator)
+  {
+    std::uniform_int_distribution<int> coordinate(-5, 5);
+
+    std::vector<Point> points;
+    for (size_t i = 0; i < nPoints; ++i)
+      points.push_back({double(coordinate(generator)),
+                        double(coordinate(generator)),
+                        double(coordinate(generator))});
+
+    std::uniform_int_distribution<size_t> index(0, nPoints - 1);
+    for (size_t i = 0; i < nPoints / 4; ++i)
+      points.push_back(points.at(index(generator)));
+
+    std::shuffle(points.begin(), points.end(), generator);
+    return points;
+  }
+
+  const std::vector<float> percentiles{0.f, 0.1f, 0.5f, 0.75f, 0.9f, 0.99f};
+
+} // namespace
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Axis_aligned_direction_with_equal_projections)
+{
+  std::mt19937 generator(71);
+  const Point start{0., 0., 0.};
+
+  for (const Point& direction :
+       {Point{0., 0., 1.}, Point{1., 0., 0.}, Point{0., -1., 0.}, Point{0., 0., -1.}}) {
+    for (const size_t nPoints : {1, 2, 5, 50, 500}) {
+      const std::vector<Point> points(MakeGridPoints(nPoints, generator));
+      for (const float percentile : percentiles)
+        CheckExtent(points, start, direction, percentile);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Oblique_direction_with_equal_perpendiculars)
+{
+  std::mt19937 generator(72);
+  const Point start{0.5, -1., 2.};
+
+  // ATTN the negative components give a projection of -0 for the start point, and +0 for points perpendicular to the
+  //      direction, which the map orderings treat as the same key
+  const double norm(std::sqrt(0.09 + 0.16 + 0.75)), diagonal(-1. / std::sqrt(3.));
+  for (const Point& direction : {Point{0.3 / norm, 0.4 / norm, std::sqrt(0.75) / norm},
+                                 Point{-0.6, -0.8, -0.},
+                                 Point{diagonal, diagonal, diagonal}}) {
+    for (const size_t nPoints : {1, 3, 40, 400}) {
+      std::vector<Point> points(MakeGridPoints(nPoints, generator));
+
+      // Add the start point and points on the axis, with a perpendicular distance of zero
+      points.push_back(start);
+      points.push_back({start.m_x + 2. * direction.m_x,
+                        start.m_y + 2. * direction.m_y,
+                        start.m_z + 2. * direction.m_z});
+      points.push_back(start);
+
+      for (const float percentile : percentiles)
+        CheckExtent(points, start, direction, percentile);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Random_points_and_directions)
+{
+  std::mt19937 generator(73);
+  std::normal_distribution<double> gaussian(0., 1.);
+  std::uniform_real_distribution<float> uniform(0.f, 0.999f);
+
+  for (unsigned int trial = 0; trial < 200; ++trial) {
+    const Point start{gaussian(generator), gaussian(generator), gaussian(generator)};
+    Point direction{gaussian(generator), gaussian(generator), gaussian(generator)};
+    const double norm(std::sqrt(direction.m_x * direction.m_x + direction.m_y * direction.m_y +
+                                direction.m_z * direction.m_z));
+    direction = {direction.m_x / norm, direction.m_y / norm, direction.m_z / norm};
+
+    // Mix continuous points with grid points and exact repeats
+    std::vector<Point> points(MakeGridPoints(1 + trial % 100, generator));
+    for (unsigned int i = 0; i < trial % 50; ++i)
+      points.push_back(
+        {10. * gaussian(generator), 10. * gaussian(generator), 10. * gaussian(generator)});
+
+    CheckExtent(points, start, direction, uniform(generator));
+  }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Invalid_input_throws)
+{
+  BOOST_CHECK_THROW(ShowerPercentileExtent({}, {}, 0.5f), cet::exception);
+  BOOST_CHECK_THROW(ShowerPercentileExtent({1., 2.}, {0.5}, 0.5f), cet::exception);
+}
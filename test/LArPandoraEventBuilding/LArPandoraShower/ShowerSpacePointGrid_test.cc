@@ -0,0 +1,322 @@
+/**
+ *  @file   test/LArPandoraEventBuilding/LArPandoraShower/ShowerSpacePointGrid_test.cc
+ *
+ *  @brief  Unit test of the spacepoint grid queries, against the ordering of all of the spacepoints in maps
+ */
+
+#define BOOST_TEST_MODULE (ShowerSpacePointGrid_test)
+#include "boost/test/unit_test.hpp"
+
+#include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Algs/ShowerSpacePointGrid.h"
+
+#include "canvas/Persistency/Common/Ptr.h"
+#include "canvas/Persistency/Provenance/ProductID.h"
+#include "cetlib_except/exception.h"
+#include "lardataobj/RecoBase/SpacePoint.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <vector>
+
+using shower::ShowerSpacePointGrid;
+
+namespace {
+
+  typedef std::vector<art::Ptr<recob::SpacePoint>> SpacePointVector;
+
+  const art::ProductID spacePointID(1);
+
+  /**
+   *  @brief  The spacepoints of a PFParticle, and the pointers to them
+   */
+  class SpacePoints {
+  public:
+    SpacePoints(const std::vector<geo::Point_t>& positions)
+    {
+      const double error[6] = {0., 0., 0., 0., 0., 0.};
+      m_spacePoints.reserve(positions.size());
+      for (const geo::Point_t& position : positions) {
+        const double xyz[3] = {position.X(), position.Y(), position.Z()};
+        m_spacePoints.emplace_back(xyz, error, 0.);
+      }
+
+      for (size_t key = 0; key < m_spacePoints.size(); ++key)
+        m_pointers.emplace_back(spacePointID, &m_spacePoints[key], key);
+    }
+
+    const SpacePointVector& Pointers() const { return m_pointers; }
+
+  private:
+    std::vector<recob::SpacePoint> m_spacePoints;
+    SpacePointVector m_pointers;
+  };
+
+  /**
+   *  @brief  The spacepoints in the cylinder before ShowerSpacePointGrid, ordered as by
+   *          LArPandoraShowerAlg::OrderShowerSpacePoints then selected as by
+   *          Shower3DCylinderTrackHitFinder::FindTrackSpacePoints
+   */
+  SpacePointVector ReferenceCylinder(const SpacePointVector& spacePoints,
+                                     const geo::Point_t& start,
+                                     const geo::Vector_t& direction,
+                                     const double maxProjection,
+                                     const double radius,
+                                     const bool forwardOnly)
+  {
+    std::map<double, art::Ptr<recob::SpacePoint>> orderedSpacePoints;
+    for (const art::Ptr<recob::SpacePoint>& spacePoint : spacePoints)
+      orderedSpacePoints[(spacePoint->position() - start).Dot(direction)] = spacePoint;
+
+    SpacePointVector selected;
+    for (const auto& entry : orderedSpacePoints) {
+      const auto pos = entry.second->position() - start;
+      const double proj = pos.Dot(direction);
+      const double perp = (pos - proj * direction).R();
+
+      if (forwardOnly && proj < 0) continue;
+
+      if (std::abs(proj) < maxProjection && std::abs(perp) < radius)
+        selected.push_back(entry.second);
+    }
+    return selected;
+  }
+
+  /**
+   *  @brief  The spacepoints in the sphere before ShowerSpacePointGrid, ordered as by
+   *          LArPandoraShowerAlg::OrderShowerSpacePoints from the start then cut at the distance as by
+   *          ShowerIncrementalTrackHitFinder
+   */
+  SpacePointVector ReferenceSphere(const SpacePointVector& spacePoints,
+                                   const geo::Point_t& centre,
+                                   const double radius)
+  {
+    std::map<double, art::Ptr<recob::SpacePoint>> orderedSpacePoints;
+    for (const art::Ptr<recob::SpacePoint>& spacePoint : spacePoints)
+      orderedSpacePoints[(spacePoint->position() - centre).R()] = spacePoint;
+
+    SpacePointVector selected;
+    for (const auto& entry : orderedSpacePoints) {
+      if (entry.first > radius) break;
+      selected.push_back(entry.second);
+    }
+    return selected;
+  }
+
+  /**
+   *  @brief  Check that the queries select and order the same spacepoints as the references
+   */
+  void CheckQueries(const ShowerSpacePointGrid& grid,
+                    const SpacePointVector& spacePoints,
+                    const geo::Point_t& start,
+                    const geo::Vector_t& direction,
+                    const double maxProjection,
+                    const double radius)
+  {
+    for (const bool forwardOnly : {false, true}) {
+      BOOST_TEST((grid.CylinderQuery(start, direction, maxProjection, radius, forwardOnly) ==
+                  ReferenceCylinder(
+                    spacePoints, start, direction, maxProjection, radius, forwardOnly)));
+    }
+
+    BOOST_TEST((grid.SphereQuery(start, maxProjection) ==
+                ReferenceSphere(spacePoints, start, maxProjection)));
+  }
+
+  /**
+   *  @brief  Make points on an integer grid, so that many projections and distances are equal, and repeat some of
+   *          them exactly
+   */
+  std::vector<geo::Point_t> MakeGridPoints(const size_t nPoints, std::mt19937& generator)
+  {
+    std::uniform_int_distribution<int> coordinate(-5, 5);
+
+    std::vector<geo::Point_t> points;
+    for (size_t i = 0; i < nPoints; ++i)
+      points.emplace_back(coordinate(generator), coordinate(generator), coordinate(generator));
+
+    std::uniform_int_distribution<size_t> index(0, nPoints - 1);
+    for (size_t i = 0; i < nPoints / 4; ++i)
+      points.push_back(points.at(index(generator)));
+
+    std::shuffle(points.begin(), points.end(), generator);
+    return points;
+  }
+
+  geo::Vector_t Unit(const geo::Vector_t& vector)
+  {
+    return vector * (1. / vector.R());
+  }
+
+} // namespace
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Equal_projections_and_repeated_points)
+{
+  std::mt19937 generator(721);
+  const double diagonal(1. / std::sqrt(3.));
+
+  for (const size_t nPoints : {1, 2, 10, 100, 1000}) {
+    const SpacePoints spacePoints(MakeGridPoints(nPoints, generator));
+
+    for (const double cellSize : {0.3, 1., 2.5, 1e6}) {
+      const ShowerSpacePointGrid grid(spacePoints.Pointers(), cellSize);
+      BOOST_TEST(grid.NumSpacePoints() == spacePoints.Pointers().size());
+
+      for (const geo::Vector_t& direction : {geo::Vector_t(0., 0., 1.),
+                                             geo::Vector_t(-1., 0., 0.),
+                                             geo::Vector_t(diagonal, diagonal, diagonal),
+                                             Unit(geo::Vector_t(1., -2., 2.))}) {
+        for (const geo::Point_t& start : {geo::Point_t(0., 0., 0.), geo::Point_t(1., -2., 0.5)}) {
+          // Integer distances on the grid lie exactly on the boundaries of the selections
+          for (const double maxProjection : {1., 3., 4.5})
+            for (const double radius : {0.5, 1., 2.})
+              CheckQueries(grid, spacePoints.Pointers(), start, direction, maxProjection, radius);
+        }
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Later_spacepoint_outside_replaces_selected)
+{
+  const geo::Point_t start(0., 0., 0.);
+  const geo::Vector_t direction(0., 0., 1.);
+  const geo::Point_t inside(0., 0., 1.), outside(10., 0., 1.), other(0., 0., 2.);
+
+  // The spacepoint outside the cylinder has the same projection as one inside, and replaces it if later
+  const SpacePoints outsideLast({inside, other, outside});
+  const ShowerSpacePointGrid outsideLastGrid(outsideLast.Pointers(), 1.);
+  BOOST_TEST((outsideLastGrid.CylinderQuery(start, direction, 5., 1., true) ==
+              SpacePointVector{outsideLast.Pointers().at(1)}));
+
+  const SpacePoints outsideFirst({outside, other, inside});
+  const ShowerSpacePointGrid outsideFirstGrid(outsideFirst.Pointers(), 1.);
+  BOOST_TEST((outsideFirstGrid.CylinderQuery(start, direction, 5., 1., true) ==
+              SpacePointVector{outsideFirst.Pointers().at(2), outsideFirst.Pointers().at(1)}));
+
+  // Of repeated spacepoints, the last is kept
+  const SpacePoints repeated({inside, other, inside});
+  const ShowerSpacePointGrid repeatedGrid(repeated.Pointers(), 1.);
+  BOOST_TEST((repeatedGrid.CylinderQuery(start, direction, 5., 1., true) ==
+              SpacePointVector{repeated.Pointers().at(2), repeated.Pointers().at(1)}));
+  BOOST_TEST((repeatedGrid.SphereQuery(start, 5.) ==
+              SpacePointVector{repeated.Pointers().at(2), repeated.Pointers().at(1)}));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Near_unit_directions_and_points_on_the_boundaries)
+{
+  std::mt19937 generator(722);
+  std::normal_distribution<double> gaussian(0., 1.);
+  std::uniform_real_distribution<double> uniform(-1., 1.), tolerance(-0.9e-6, 0.9e-6);
+
+  for (unsigned int trial = 0; trial < 300; ++trial) {
+    const geo::Point_t start(
+      100. * gaussian(generator), 100. * gaussian(generator), 100. * gaussian(generator));
+    const geo::Vector_t unit(
+      Unit(geo::Vector_t(gaussian(generator), gaussian(generator), gaussian(generator))));
+    const geo::Vector_t perpendicular(Unit(unit.Cross(
+      geo::Vector_t(gaussian(generator), gaussian(generator), gaussian(generator)))));
+
+    // A direction normalised within the tolerance of the bounding box, so the box is padded for it
+    const geo::Vector_t direction(unit * std::sqrt(1. + tolerance(generator)));
+    const double maxProjection(1. + 20. * std::abs(gaussian(generator)));
+    const double radius((trial % 2) ? 1e-3 : 1. + std::abs(gaussian(generator)));
+
+    // Points at the ends and the surface of the cylinder and the surface of the sphere
+    std::vector<geo::Point_t> points;
+    for (const double fraction : {1. - 1e-12, 1., 1. + 1e-12}) {
+      const double along(fraction * maxProjection / direction.R());
+      const double across(fraction * radius);
+
+      for (const double sign : {-1., 1.}) {
+        points.push_back(start + (sign * along) * unit);
+        points.push_back(start + (sign * along) * unit + across * perpendicular);
+        points.push_back(start + (sign * uniform(generator) * along) * unit +
+                         across * perpendicular);
+        points.push_back(start + (fraction * maxProjection) *
+                                   Unit(geo::Vector_t(sign * uniform(generator),
+                                                      uniform(generator),
+                                                      uniform(generator))));
+      }
+    }
+
+    for (unsigned int i = 0; i < 50; ++i)
+      points.push_back(start + geo::Vector_t(maxProjection * uniform(generator),
+                                             maxProjection * uniform(generator),
+                                             maxProjection * uniform(generator)));
+
+    const SpacePoints spacePoints(points);
+    const ShowerSpacePointGrid grid(spacePoints.Pointers(), 0.1 + std::abs(gaussian(generator)));
+    CheckQueries(grid, spacePoints.Pointers(), start, direction, maxProjection, radius);
+  }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Non_unit_directions_visit_every_cell)
+{
+  std::mt19937 generator(723);
+  const SpacePoints spacePoints(MakeGridPoints(500, generator));
+  const ShowerSpacePointGrid grid(spacePoints.Pointers(), 1.);
+  const geo::Point_t start(0., 0., 0.);
+
+  // Directions outside the tolerance are not bounded by the box of a unit direction
+  for (const geo::Vector_t& direction : {geo::Vector_t(0., 0., 0.5),
+                                         geo::Vector_t(0., 0., 2.),
+                                         geo::Vector_t(1., 1., 0.),
+                                         geo::Vector_t(0., 0., 1. - 1e-5)}) {
+    for (const double maxProjection : {1., 2., 3.5})
+      for (const double radius : {0.5, 1.5, 4.})
+        CheckQueries(grid, spacePoints.Pointers(), start, direction, maxProjection, radius);
+  }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Cell_size_enlargement)
+{
+  std::mt19937 generator(724);
+  std::uniform_real_distribution<double> uniform(-500., 500.);
+
+  // Spread spacepoints and spacepoints at a single position, with cells far too small for either
+  std::vector<geo::Point_t> spread;
+  for (unsigned int i = 0; i < 2000; ++i)
+    spread.emplace_back(uniform(generator), uniform(generator), 0.01 * uniform(generator));
+
+  for (const std::vector<geo::Point_t>& points :
+       {spread, std::vector<geo::Point_t>(20, geo::Point_t(1., 2., 3.))}) {
+    const SpacePoints spacePoints(points);
+
+    for (const double cellSize : {1e-4, 0.5, 30.}) {
+      const ShowerSpacePointGrid grid(spacePoints.Pointers(), cellSize);
+
+      for (unsigned int trial = 0; trial < 20; ++trial) {
+        const geo::Point_t start(points.at(trial % points.size()));
+        const geo::Vector_t direction(Unit(geo::Vector_t(
+          uniform(generator), uniform(generator), 0.01 * uniform(generator))));
+        CheckQueries(grid, spacePoints.Pointers(), start, direction, 150., 20.);
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Empty_grid_and_invalid_cell_size)
+{
+  const ShowerSpacePointGrid grid(SpacePointVector(), 1.);
+  BOOST_TEST(grid.NumSpacePoints() == 0u);
+  BOOST_TEST(grid.CylinderQuery(geo::Point_t(0., 0., 0.), geo::Vector_t(0., 0., 1.), 10., 10., false)
+               .empty());
+  BOOST_TEST(grid.SphereQuery(geo::Point_t(0., 0., 0.), 10.).empty());
+
+  BOOST_CHECK_THROW(ShowerSpacePointGrid(SpacePointVector(), 0.), cet::exception);
+  BOOST_CHECK_THROW(ShowerSpacePointGrid(SpacePointVector(), -1.), cet::exception);
+}
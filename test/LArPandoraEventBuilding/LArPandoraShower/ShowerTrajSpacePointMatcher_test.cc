@@ -0,0 +1,158 @@
+/**
+ *  @file   test/LArPandoraEventBuilding/LArPandoraShower/ShowerTrajSpacePointMatcher_test.cc
+ *
+ *  @brief  Unit test of the trajectory point to spacepoint matching, against the check of every remaining spacepoint
+ */
+
+#define BOOST_TEST_MODULE (ShowerTrajSpacePointMatcher_test)
+#include "boost/test/unit_test.hpp"
+
+#include "larpandora/LArPandoraEventBuilding/LArPandoraShower/Algs/ShowerTrajSpacePointMatcher.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using shower::ShowerTrajSpacePointMatcher;
+
+namespace {
+
+  /**
+   *  @brief  The matches before ShowerTrajSpacePointMatcher, as in ShowerTrackTrajToSpacePoint, checking every
+   *          remaining spacepoint for each trajectory point and erasing the match. The not-found value is the number
+   *          of spacepoints, rather than the old value of 999, which was also a valid position.
+   */
+  std::vector<size_t> ReferenceMatches(const std::vector<geo::Point_t>& spacePoints,
+                                       const std::vector<geo::Point_t>& trajectory,
+                                       const float fMaxDist)
+  {
+    std::vector<size_t> remaining;
+    for (size_t sp = 0; sp < spacePoints.size(); ++sp)
+      remaining.push_back(sp);
+
+    std::vector<size_t> matches;
+    for (const geo::Point_t& TrajPosition : trajectory) {
+      float MinDist = 9999;
+      size_t index = remaining.size();
+      for (size_t sp = 0; sp < remaining.size(); ++sp) {
+        auto const dist = (spacePoints[remaining[sp]] - TrajPosition).R();
+        if (dist < MinDist && dist < fMaxDist) {
+          MinDist = dist;
+          index = sp;
+        }
+      }
+
+      if (index == remaining.size()) {
+        matches.push_back(spacePoints.size());
+        continue;
+      }
+
+      matches.push_back(remaining[index]);
+      remaining.erase(remaining.begin() + index);
+    }
+    return matches;
+  }
+
+  /**
+   *  @brief  Check that the matcher gives the same match as the reference for each trajectory point
+   */
+  void CheckMatches(const std::vector<geo::Point_t>& spacePoints,
+                    const std::vector<geo::Point_t>& trajectory,
+                    const float maxDist)
+  {
+    ShowerTrajSpacePointMatcher matcher(spacePoints, maxDist);
+    BOOST_TEST(matcher.NumSpacePoints() == spacePoints.size());
+
+    std::vector<size_t> matches;
+    for (const geo::Point_t& position : trajectory)
+      matches.push_back(matcher.Match(position));
+
+    BOOST_TEST(matches == ReferenceMatches(spacePoints, trajectory, maxDist));
+  }
+
+} // namespace
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Random_tracks_on_a_grid)
+{
+  std::mt19937 generator(731);
+  std::uniform_real_distribution<double> uniform(0., 20.);
+  std::uniform_int_distribution<int> axis(0, 2);
+
+  // Positions on a quarter-unit grid, so that many distances are equal, with the largest spread along each axis
+  const auto gridPoint = [&](const double stretch, const int longAxis) {
+    double xyz[3] = {std::round(uniform(generator) * 4.) / 4.,
+                     std::round(uniform(generator) * 4.) / 4.,
+                     std::round(uniform(generator) * 4.) / 4.};
+    xyz[longAxis] = std::round(stretch * xyz[longAxis] * 4.) / 4.;
+    return geo::Point_t(xyz[0], xyz[1], xyz[2]);
+  };
+
+  for (unsigned int trial = 0; trial < 3000; ++trial) {
+    const size_t nSpacePoints(generator() % 400), nTrajectoryPoints(generator() % 150);
+    const float maxDist(0.2f + (generator() % 30) / 10.f);
+    const double stretch(1. + (trial % 4));
+    const int longAxis(axis(generator));
+
+    std::vector<geo::Point_t> spacePoints, trajectory;
+    for (size_t i = 0; i < nSpacePoints; ++i)
+      spacePoints.push_back(gridPoint(stretch, longAxis));
+
+    // Repeat some spacepoints exactly
+    for (size_t i = 0; i < nSpacePoints / 10; ++i)
+      spacePoints.push_back(spacePoints.at(generator() % nSpacePoints));
+
+    for (size_t i = 0; i < nTrajectoryPoints; ++i)
+      trajectory.push_back(gridPoint(stretch, longAxis));
+
+    CheckMatches(spacePoints, trajectory, maxDist);
+  }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Track_like_spacepoints_along_oblique_directions)
+{
+  std::mt19937 generator(732);
+  std::normal_distribution<double> gaussian(0., 1.);
+
+  for (unsigned int trial = 0; trial < 200; ++trial) {
+    const geo::Point_t start(
+      100. * gaussian(generator), 100. * gaussian(generator), 100. * gaussian(generator));
+    const geo::Vector_t step(gaussian(generator), gaussian(generator), gaussian(generator));
+
+    // Spacepoints scattered about a straight track, and trajectory points along it
+    std::vector<geo::Point_t> spacePoints, trajectory;
+    for (unsigned int i = 0; i < 1500; ++i)
+      spacePoints.push_back(start + (0.05 * i) * step +
+                            geo::Vector_t(0.3 * gaussian(generator),
+                                          0.3 * gaussian(generator),
+                                          0.3 * gaussian(generator)));
+
+    for (unsigned int i = 0; i < 200; ++i)
+      trajectory.push_back(start + (0.4 * i) * step);
+
+    CheckMatches(spacePoints, trajectory, 0.5f + 0.1f * (trial % 10));
+  }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Every_spacepoint_matched_once)
+{
+  // More than 64 spacepoints at one position, so that the bitmaps span words, and a trajectory point beyond the range
+  const std::vector<geo::Point_t> spacePoints(130, geo::Point_t(1., 2., 3.));
+  ShowerTrajSpacePointMatcher matcher(spacePoints, 1.f);
+
+  for (size_t sp = 0; sp < spacePoints.size(); ++sp)
+    BOOST_TEST(matcher.Match(geo::Point_t(1., 2., 3.5)) == sp);
+
+  BOOST_TEST(matcher.Match(geo::Point_t(1., 2., 3.)) == spacePoints.size());
+
+  ShowerTrajSpacePointMatcher farMatcher(spacePoints, 1.f);
+  BOOST_TEST(farMatcher.Match(geo::Point_t(1., 2., 4.)) == spacePoints.size());
+
+  ShowerTrajSpacePointMatcher emptyMatcher({}, 1.f);
+  BOOST_TEST(emptyMatcher.Match(geo::Point_t(0., 0., 0.)) == 0u);
+}
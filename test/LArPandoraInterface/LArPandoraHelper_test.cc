@@ -0,0 +1,258 @@
+/**
+ *  @file   test/LArPandoraInterface/LArPandoraHelper_test.cc
+ *
+ *  @brief  Unit test of the reco-true matching in LArPandoraHelper, against the recursive matching over maps and sets
+ */
+
+#define BOOST_TEST_MODULE (LArPandoraHelper_test)
+#include "boost/test/unit_test.hpp"
+
+#include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
+
+#include "canvas/Persistency/Provenance/ProductID.h"
+#include "lardataobj/RecoBase/Hit.h"
+#include "lardataobj/RecoBase/PFParticle.h"
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+using lar_pandora::HitVector;
+using lar_pandora::HitsToMCParticles;
+using lar_pandora::LArPandoraHelper;
+using lar_pandora::MCParticlesToHits;
+using lar_pandora::MCParticlesToPFParticles;
+using lar_pandora::PFParticlesToHits;
+
+namespace {
+
+  const art::ProductID hitID(1);
+  const art::ProductID particleID(2);
+  const art::ProductID trueID(3);
+
+  art::Ptr<recob::Hit> MakeHit(const size_t key)
+  {
+    return art::Ptr<recob::Hit>(hitID, key, nullptr);
+  }
+
+  art::Ptr<recob::PFParticle> MakeParticle(const size_t key)
+  {
+    return art::Ptr<recob::PFParticle>(particleID, key, nullptr);
+  }
+
+  art::Ptr<simb::MCParticle> MakeTrueParticle(const size_t key)
+  {
+    return art::Ptr<simb::MCParticle>(trueID, key, nullptr);
+  }
+
+  /**
+   *  @brief  The matching before LArPandoraHelper::MatchRecoToTrue, as in PFParticleMonitoring::GetRecoToTrueMatches,
+   *          with the vetoed objects held in sets and the recursion repeated on the same output maps
+   */
+  void ReferenceMatches(const PFParticlesToHits& recoParticlesToHits,
+                        const HitsToMCParticles& trueHitsToParticles,
+                        const bool recursiveMatching,
+                        MCParticlesToPFParticles& matchedParticles,
+                        MCParticlesToHits& matchedHits,
+                        std::set<art::Ptr<recob::PFParticle>>& vetoReco,
+                        std::set<art::Ptr<simb::MCParticle>>& vetoTrue)
+  {
+    bool foundMatches(false);
+
+    for (const auto& recoEntry : recoParticlesToHits) {
+      const art::Ptr<recob::PFParticle> recoParticle = recoEntry.first;
+      if (vetoReco.count(recoParticle) > 0) continue;
+
+      MCParticlesToHits truthContributionMap;
+
+      for (const art::Ptr<recob::Hit>& hit : recoEntry.second) {
+        HitsToMCParticles::const_iterator iter = trueHitsToParticles.find(hit);
+        if (trueHitsToParticles.end() == iter) continue;
+
+        const art::Ptr<simb::MCParticle> trueParticle = iter->second;
+        if (vetoTrue.count(trueParticle) > 0) continue;
+
+        truthContributionMap[trueParticle].push_back(hit);
+      }
+
+      MCParticlesToHits::const_iterator mIter = truthContributionMap.end();
+
+      for (MCParticlesToHits::const_iterator iter = truthContributionMap.begin();
+           iter != truthContributionMap.end();
+           ++iter) {
+        if ((truthContributionMap.end() == mIter) || (iter->second.size() > mIter->second.size()))
+          mIter = iter;
+      }
+
+      if (truthContributionMap.end() != mIter) {
+        const art::Ptr<simb::MCParticle> trueParticle = mIter->first;
+        MCParticlesToHits::const_iterator hitIter = matchedHits.find(trueParticle);
+
+        if ((matchedHits.end() == hitIter) || (mIter->second.size() > hitIter->second.size())) {
+          matchedParticles[trueParticle] = recoParticle;
+          matchedHits[trueParticle] = mIter->second;
+          foundMatches = true;
+        }
+      }
+    }
+
+    if (!foundMatches) return;
+
+    for (const auto& match : matchedParticles) {
+      vetoTrue.insert(match.first);
+      vetoReco.insert(match.second);
+    }
+
+    if (recursiveMatching)
+      ReferenceMatches(recoParticlesToHits,
+                       trueHitsToParticles,
+                       recursiveMatching,
+                       matchedParticles,
+                       matchedHits,
+                       vetoReco,
+                       vetoTrue);
+  }
+
+  /**
+   *  @brief  Check that LArPandoraHelper::MatchRecoToTrue gives the same matches and shared hits as the reference
+   */
+  void CheckMatches(const PFParticlesToHits& recoParticlesToHits,
+                    const HitsToMCParticles& trueHitsToParticles,
+                    const bool recursiveMatching)
+  {
+    MCParticlesToPFParticles referenceParticles;
+    MCParticlesToHits referenceHits;
+    std::set<art::Ptr<recob::PFParticle>> vetoReco;
+    std::set<art::Ptr<simb::MCParticle>> vetoTrue;
+    ReferenceMatches(recoParticlesToHits,
+                     trueHitsToParticles,
+                     recursiveMatching,
+                     referenceParticles,
+                     referenceHits,
+                     vetoReco,
+                     vetoTrue);
+
+    MCParticlesToPFParticles matchedParticles;
+    MCParticlesToHits matchedHits;
+    LArPandoraHelper::MatchRecoToTrue(
+      recoParticlesToHits, trueHitsToParticles, recursiveMatching, matchedParticles, matchedHits);
+
+    BOOST_TEST((matchedParticles == referenceParticles));
+    BOOST_TEST((matchedHits == referenceHits));
+  }
+
+} // namespace
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Ties_and_recursion)
+{
+  // Particle 0 shares 3 hits with each of true particles 0 and 1, and takes the first in the ordering of the maps;
+  // particle 1 shares 5 hits with true particle 0, so takes it from particle 0, which can then only match true
+  // particle 1 in a further round. Particle 2 ties with particle 3 for true particle 2 and, as the first, keeps it.
+  HitsToMCParticles trueHitsToParticles;
+  for (size_t key = 0; key < 3; ++key)
+    trueHitsToParticles[MakeHit(key)] = MakeTrueParticle(0);
+  for (size_t key = 3; key < 6; ++key)
+    trueHitsToParticles[MakeHit(key)] = MakeTrueParticle(1);
+  for (size_t key = 6; key < 11; ++key)
+    trueHitsToParticles[MakeHit(key)] = MakeTrueParticle(0);
+  for (size_t key = 11; key < 15; ++key)
+    trueHitsToParticles[MakeHit(key)] = MakeTrueParticle(2);
+
+  PFParticlesToHits recoParticlesToHits;
+  recoParticlesToHits[MakeParticle(0)] = {
+    MakeHit(5), MakeHit(0), MakeHit(3), MakeHit(1), MakeHit(4), MakeHit(2), MakeHit(100)};
+  recoParticlesToHits[MakeParticle(1)] = {
+    MakeHit(6), MakeHit(7), MakeHit(8), MakeHit(9), MakeHit(10)};
+  recoParticlesToHits[MakeParticle(2)] = {MakeHit(11), MakeHit(12)};
+  recoParticlesToHits[MakeParticle(3)] = {MakeHit(13), MakeHit(14)};
+  recoParticlesToHits[MakeParticle(4)] = {MakeHit(101)};
+
+  for (const bool recursiveMatching : {false, true}) {
+    MCParticlesToPFParticles matchedParticles;
+    MCParticlesToHits matchedHits;
+    LArPandoraHelper::MatchRecoToTrue(
+      recoParticlesToHits, trueHitsToParticles, recursiveMatching, matchedParticles, matchedHits);
+
+    BOOST_TEST(matchedParticles.size() == (recursiveMatching ? 3u : 2u));
+    BOOST_TEST((matchedParticles.at(MakeTrueParticle(0)) == MakeParticle(1)));
+    BOOST_TEST((matchedParticles.at(MakeTrueParticle(2)) == MakeParticle(2)));
+    BOOST_TEST((matchedHits.at(MakeTrueParticle(0)) == recoParticlesToHits.at(MakeParticle(1))));
+
+    if (recursiveMatching) {
+      BOOST_TEST((matchedParticles.at(MakeTrueParticle(1)) == MakeParticle(0)));
+      BOOST_TEST(
+        (matchedHits.at(MakeTrueParticle(1)) == HitVector{MakeHit(5), MakeHit(3), MakeHit(4)}));
+    }
+
+    CheckMatches(recoParticlesToHits, trueHitsToParticles, recursiveMatching);
+  }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Output_maps_are_replaced)
+{
+  HitsToMCParticles trueHitsToParticles;
+  trueHitsToParticles[MakeHit(0)] = MakeTrueParticle(0);
+
+  PFParticlesToHits recoParticlesToHits;
+  recoParticlesToHits[MakeParticle(0)] = {MakeHit(0)};
+
+  MCParticlesToPFParticles matchedParticles;
+  MCParticlesToHits matchedHits;
+  matchedParticles[MakeTrueParticle(0)] = MakeParticle(7);
+  matchedParticles[MakeTrueParticle(5)] = MakeParticle(8);
+  matchedHits[MakeTrueParticle(0)] = {MakeHit(1), MakeHit(2)};
+  matchedHits[MakeTrueParticle(5)] = {MakeHit(3)};
+
+  LArPandoraHelper::MatchRecoToTrue(
+    recoParticlesToHits, trueHitsToParticles, true, matchedParticles, matchedHits);
+
+  BOOST_TEST(
+    (matchedParticles == MCParticlesToPFParticles{{MakeTrueParticle(0), MakeParticle(0)}}));
+  BOOST_TEST((matchedHits == MCParticlesToHits{{MakeTrueParticle(0), HitVector{MakeHit(0)}}}));
+
+  LArPandoraHelper::MatchRecoToTrue(
+    PFParticlesToHits(), trueHitsToParticles, true, matchedParticles, matchedHits);
+
+  BOOST_TEST(matchedParticles.empty());
+  BOOST_TEST(matchedHits.empty());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Random_shared_hits)
+{
+  std::mt19937 generator(65);
+
+  for (unsigned int trial = 0; trial < 500; ++trial) {
+    // Few true particles and short hit lists, so that many hit counts are equal
+    const size_t nHits(1 + trial % 60), nTrue(1 + trial % 7), nReco(1 + trial % 11);
+    std::uniform_int_distribution<size_t> trueKey(0, nTrue - 1), recoKey(0, nReco - 1),
+      hitKey(0, nHits - 1), choice(0, 9);
+
+    HitsToMCParticles trueHitsToParticles;
+    PFParticlesToHits recoParticlesToHits;
+
+    for (size_t key = 0; key < nHits; ++key) {
+      if (choice(generator) > 0)
+        trueHitsToParticles[MakeHit(key)] = MakeTrueParticle(trueKey(generator));
+
+      if (choice(generator) > 1)
+        recoParticlesToHits[MakeParticle(recoKey(generator))].push_back(MakeHit(key));
+    }
+
+    // Share some hits between particles, and repeat some within a particle
+    for (size_t i = 0; i < nHits / 5; ++i)
+      recoParticlesToHits[MakeParticle(recoKey(generator))].push_back(MakeHit(hitKey(generator)));
+
+    for (auto& recoEntry : recoParticlesToHits)
+      std::shuffle(recoEntry.second.begin(), recoEntry.second.end(), generator);
+
+    for (const bool recursiveMatching : {false, true})
+      CheckMatches(recoParticlesToHits, trueHitsToParticles, recursiveMatching);
+  }
+}
@@ -0,0 +1,124 @@
+/**
+ *  @file   test/LArPandoraInterface/LArPandoraOutput_test.cc
+ *
+ *  @brief  Unit test of the hit sort in LArPandoraOutput, against a std::sort with LArClusterHelper::SortHitsByPosition
+ */
+
+#define BOOST_TEST_MODULE (LArPandoraOutput_test)
+#include "boost/test/unit_test.hpp"
+
+#include "larpandora/LArPandoraInterface/LArPandoraOutput.h"
+
+#include "larpandoracontent/LArHelpers/LArClusterHelper.h"
+#include "larpandoracontent/LArObjects/LArCaloHit.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+using lar_pandora::LArPandoraOutput;
+
+namespace {
+
+  /**
+   *  @brief  Make a 3D hit, with the parameters set as in LArPandoraInput::CreatePandoraHits2D
+   */
+  std::unique_ptr<lar_content::LArCaloHit> MakeHit(const float x,
+                                                   const float y,
+                                                   const float z,
+                                                   const float energy,
+                                                   const size_t hitIndex)
+  {
+    lar_content::LArCaloHitParameters parameters;
+    parameters.m_positionVector = pandora::CartesianVector(x, y, z);
+    parameters.m_expectedDirection = pandora::CartesianVector(0., 0., 1.);
+    parameters.m_cellNormalVector = pandora::CartesianVector(0., 0., 1.);
+    parameters.m_cellSize0 = 0.5f;
+    parameters.m_cellSize1 = 0.5f;
+    parameters.m_cellThickness = 0.3f;
+    parameters.m_cellGeometry = pandora::RECTANGULAR;
+    parameters.m_time = 0.;
+    parameters.m_nCellRadiationLengths = 0.04f;
+    parameters.m_nCellInteractionLengths = 0.006f;
+    parameters.m_isDigital = false;
+    parameters.m_hitRegion = pandora::SINGLE_REGION;
+    parameters.m_layer = 0;
+    parameters.m_isInOuterSamplingLayer = false;
+    parameters.m_inputEnergy = energy;
+    parameters.m_mipEquivalentEnergy = energy;
+    parameters.m_electromagneticEnergy = energy;
+    parameters.m_hadronicEnergy = energy;
+    parameters.m_pParentAddress = (void*)((intptr_t)(hitIndex + 1));
+    parameters.m_larTPCVolumeId = 0;
+    parameters.m_daughterVolumeId = 0;
+    parameters.m_hitType = pandora::TPC_3D;
+
+    return std::make_unique<lar_content::LArCaloHit>(parameters);
+  }
+
+  /**
+   *  @brief  Make hits on a coarse grid, offset by multiples of float epsilon so that many coordinates are equal within
+   *          epsilon without being identical, with a few pulse heights and some hits at identical positions
+   */
+  std::vector<std::unique_ptr<lar_content::LArCaloHit>> MakeHits(const size_t nHits,
+                                                                 std::mt19937& generator)
+  {
+    const float epsilon(std::numeric_limits<float>::epsilon());
+    const std::vector<float> offsets{0.f, 0.5f * epsilon, epsilon, 1.5f * epsilon, 3.f * epsilon};
+    std::uniform_int_distribution<int> coarse(0, 2), offset(0, static_cast<int>(offsets.size()) - 1),
+      energy(1, 3);
+
+    std::vector<std::unique_ptr<lar_content::LArCaloHit>> hits;
+    for (size_t i = 0; i < nHits; ++i) {
+      const float x(0.5f * coarse(generator) + offsets.at(offset(generator)));
+      const float y(0.5f * coarse(generator) + offsets.at(offset(generator)));
+      const float z(0.5f * coarse(generator) + offsets.at(offset(generator)));
+      hits.push_back(MakeHit(x, y, z, energy(generator), i));
+    }
+
+    return hits;
+  }
+
+  /**
+   *  @brief  Check that LArPandoraOutput::SortHitsByPosition gives the same permutation as the std::sort it replaces
+   */
+  void CheckSort(const pandora::CaloHitVector& caloHits)
+  {
+    pandora::CaloHitVector reference(caloHits);
+    std::sort(reference.begin(), reference.end(), lar_content::LArClusterHelper::SortHitsByPosition);
+
+    pandora::CaloHitVector sorted(caloHits);
+    LArPandoraOutput::SortHitsByPosition(sorted);
+
+    BOOST_TEST(sorted == reference);
+  }
+
+} // namespace
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(Sort_matches_LArClusterHelper_order)
+{
+  std::mt19937 generator(59);
+
+  for (const size_t nHits : {0, 1, 2, 17, 100, 1000, 5000}) {
+    const std::vector<std::unique_ptr<lar_content::LArCaloHit>> hits(MakeHits(nHits, generator));
+
+    pandora::CaloHitVector caloHits;
+    for (const auto& pHit : hits)
+      caloHits.push_back(pHit.get());
+
+    for (unsigned int shuffle = 0; shuffle < 5; ++shuffle) {
+      std::shuffle(caloHits.begin(), caloHits.end(), generator);
+      CheckSort(caloHits);
+    }
+
+    // Partially ordered input, as for the hits of a pfo that are appended to an already sorted vector
+    std::sort(caloHits.begin(), caloHits.end(), lar_content::LArClusterHelper::SortHitsByPosition);
+    std::reverse(caloHits.begin() + caloHits.size() / 2, caloHits.end());
+    CheckSort(caloHits);
+  }
+}